@@ -0,0 +1,405 @@
+#pragma once
+
+#include "JobPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef ASSET_PACK_ZSTD
+#include <zstd.h>
+#endif
+
+//ߺ決Դ,asset_cookд,ʱȡ
+//: PackHeader | PackEntry[entryCount](nameHash) | ݿ,Ŀ¼ÿݿ鶼64ֽڶ
+//ݿ鰴ݹϣȥ,ͬԴͬһƫ
+const uint32_t ASSET_PACK_MAGIC = 0x4b504b56; //"VKPK"
+const uint32_t ASSET_PACK_VERSION = 4;
+const uint64_t ASSET_PACK_ALIGNMENT = 64;
+//ѹԴ̶Сֿѹ,ѹʱԲ
+const uint32_t ASSET_CHUNK_SIZE = 256 * 1024;
+
+enum AssetType : uint32_t
+{
+	ASSET_TYPE_SHADER = 1,
+	ASSET_TYPE_TEXTURE = 2,
+	ASSET_TYPE_MESH = 3,
+	ASSET_TYPE_TEXTURE_TABLE = 4
+};
+
+enum AssetCompression : uint32_t
+{
+	ASSET_COMPRESSION_NONE = 0,
+	ASSET_COMPRESSION_ZSTD = 1
+};
+
+struct PackHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+	uint64_t tocOffset;
+	uint64_t dataOffset;
+};
+
+//sizeǰд洢ֽ,uncompressedSizeǽѹֽ,δѹʱ
+//contentHashǽѹݵĹϣ
+struct PackEntry
+{
+	uint64_t nameHash;
+	uint64_t contentHash;
+	uint64_t offset;
+	uint64_t size;
+	uint64_t uncompressedSize;
+	uint32_t type;
+	uint32_t compression;
+};
+
+//ѹԴԷֿͷ,chunkCount+1Դƫ,ٺǸѹ
+struct CompressedChunkTable
+{
+	uint32_t chunkCount;
+	uint32_t chunkSize;
+};
+
+//: TextureAssetHeader | TextureMipLevel[mipCount] | 
+//blockWidth/blockHeight/blockBytesѹ,δѹʽΪ1x1ÿֽ
+//еǴҳ(2D),ÿmip㼶ڸν
+struct TextureAssetHeader
+{
+	uint32_t format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	uint32_t blockWidth;
+	uint32_t blockHeight;
+	uint32_t blockBytes;
+	uint32_t layerCount;
+};
+
+//offsetԴݵ,size,width/heightǵĳߴ
+struct TextureMipLevel
+{
+	uint64_t offset;
+	uint64_t size;
+	uint32_t width;
+	uint32_t height;
+};
+
+//: TextureTableHeader | TextureRegion[regionCount](nameHash)
+//ҳԴtexturePageName,Դӳ䵽ҳеһһӾ
+const char* const TEXTURE_TABLE_NAME = "texture_pages/table";
+
+struct TextureTableHeader
+{
+	uint32_t pageCount;
+	uint32_t regionCount;
+};
+
+//uvScale/uvOffsetԴ[0,1]ӳ䵽ҳеӾ
+struct TextureRegion
+{
+	uint64_t nameHash;
+	uint32_t page;
+	uint32_t layer;
+	float uvScale[2];
+	float uvOffset[2];
+};
+
+inline std::string texturePageName(uint32_t page)
+{
+	return "texture_pages/" + std::to_string(page);
+}
+
+//: MeshAssetHeader | MeshLod[lodCount] | MeshVertex[vertexCount] | uint32_t[indexCount]
+//LOD,Եδ,indexCountLOD
+//ÿLOD㻺Ż,㰴ֵϸLOD״ʹõ˳
+const uint32_t MAX_MESH_LODS = 6;
+
+struct MeshAssetHeader
+{
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t vertexStride;
+	uint32_t indexSize;
+	uint32_t lodCount;
+};
+
+//errorϸһļƫϽ,붥λͬλ
+struct MeshLod
+{
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	float error;
+};
+
+struct MeshVertex
+{
+	float position[3];
+	float normal[3];
+	float texCoord[2];
+};
+
+//FNV-1a 64λ,Դݶϣ
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+//ԴresourceĿ¼·,ʹ'/'ָ,"shaders/vertex.vert"
+inline uint64_t hashAssetName(const char* name)
+{
+	return hashBytes(name, strlen(name));
+}
+
+//Դӳ䵽ڴ,δѹԴֱӷӳͼ,κθ
+//ѹԴreadѹṩڴ(staging),ڹ̳߳ϲнѹ
+class AssetPack
+{
+public:
+	~AssetPack()
+	{
+		close();
+	}
+
+	//jobsΪʱڵ߳Ͻѹ
+	bool open(const char* path, JobPool* jobs)
+	{
+		close();
+		if (!map(path))
+			return false;
+
+		const PackHeader* header = reinterpret_cast<const PackHeader*>(_base);
+		if (_size < sizeof(PackHeader) || header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION
+			|| header->tocOffset % alignof(PackEntry) != 0
+			|| header->tocOffset + sizeof(PackEntry) * header->entryCount > _size)
+		{
+			close();
+			return false;
+		}
+
+		_entries = reinterpret_cast<const PackEntry*>(_base + header->tocOffset);
+		_entryCount = header->entryCount;
+
+		for (uint32_t i = 0; i < _entryCount; ++i)
+		{
+			if (_entries[i].offset + _entries[i].size > _size
+				|| (_entries[i].compression != ASSET_COMPRESSION_NONE && !validChunkTable(_entries[i])))
+			{
+				close();
+				return false;
+			}
+		}
+
+		_jobs = jobs;
+		return true;
+	}
+
+	void close()
+	{
+		unmap();
+		_jobs = nullptr;
+		_entries = nullptr;
+		_entryCount = 0;
+	}
+
+	//Ŀ¼nameHash,ֲ
+	const PackEntry* find(const char* name) const
+	{
+		uint64_t nameHash = hashAssetName(name);
+		const PackEntry* end = _entries + _entryCount;
+		const PackEntry* entry = std::lower_bound(_entries, end, nameHash,
+			[](const PackEntry& e, uint64_t hash) { return e.nameHash < hash; });
+		if (entry == end || entry->nameHash != nameHash)
+			return nullptr;
+		return entry;
+	}
+
+	//δѹԴӳͼ,ݿ64ֽڶ,ֱӵSPIR-Vʹ;ѹԴؿ
+	std::span<const uint8_t> view(const PackEntry& entry) const
+	{
+		if (entry.compression != ASSET_COMPRESSION_NONE)
+			return {};
+		return { _base + entry.offset, static_cast<size_t>(entry.size) };
+	}
+
+	//ƻѹdst,dstҪuncompressedSizeֽ,ֻһ߳ϵ
+	bool read(const PackEntry& entry, void* dst)
+	{
+		if (entry.compression == ASSET_COMPRESSION_NONE)
+		{
+			memcpy(dst, _base + entry.offset, static_cast<size_t>(entry.size));
+			return true;
+		}
+
+#ifdef ASSET_PACK_ZSTD
+		if (entry.compression != ASSET_COMPRESSION_ZSTD)
+			return false;
+
+		//ÿһ,߳Ҳѹ
+		const CompressedChunkTable* table = reinterpret_cast<const CompressedChunkTable*>(_base + entry.offset);
+		const uint64_t* offsets = reinterpret_cast<const uint64_t*>(table + 1);
+		const uint8_t* base = _base + entry.offset;
+		uint8_t* bytes = static_cast<uint8_t*>(dst);
+		std::atomic<bool> failed{ false };
+		auto decompressChunk = [&](uint32_t index)
+		{
+			uint64_t dstOffset = static_cast<uint64_t>(index) * table->chunkSize;
+			size_t dstSize = static_cast<size_t>(std::min<uint64_t>(table->chunkSize, entry.uncompressedSize - dstOffset));
+			size_t result = ZSTD_decompress(bytes + dstOffset, dstSize,
+				base + offsets[index], static_cast<size_t>(offsets[index + 1] - offsets[index]));
+			if (ZSTD_isError(result) || result != dstSize)
+				failed = true;
+		};
+
+		if (_jobs != nullptr)
+		{
+			_jobs->parallelFor(table->chunkCount, decompressChunk);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < table->chunkCount; ++i)
+			{
+				decompressChunk(i);
+			}
+		}
+		return !failed;
+#else
+		return false;
+#endif
+	}
+
+	uint32_t entryCount() const
+	{
+		return _entryCount;
+	}
+
+private:
+	//ֿѹдķΧ,øuncompressedSize,ƫƵҲԴ
+	bool validChunkTable(const PackEntry& entry) const
+	{
+		if (entry.size < sizeof(CompressedChunkTable))
+			return false;
+
+		const CompressedChunkTable* table = reinterpret_cast<const CompressedChunkTable*>(_base + entry.offset);
+		if (table->chunkSize == 0
+			|| table->chunkCount != (entry.uncompressedSize + table->chunkSize - 1) / table->chunkSize)
+			return false;
+
+		uint64_t tableSize = sizeof(CompressedChunkTable) + sizeof(uint64_t) * (static_cast<uint64_t>(table->chunkCount) + 1);
+		if (tableSize > entry.size)
+			return false;
+
+		const uint64_t* offsets = reinterpret_cast<const uint64_t*>(table + 1);
+		if (offsets[0] < tableSize)
+			return false;
+		for (uint32_t i = 0; i < table->chunkCount; ++i)
+		{
+			if (offsets[i + 1] < offsets[i] || offsets[i + 1] > entry.size)
+				return false;
+		}
+		return true;
+	}
+
+	bool map(const char* path)
+	{
+#ifdef _WIN32
+		_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (_file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			unmap();
+			return false;
+		}
+		_size = static_cast<size_t>(fileSize.QuadPart);
+
+		_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (_mapping == nullptr)
+		{
+			unmap();
+			return false;
+		}
+
+		_base = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+		if (_base == nullptr)
+		{
+			unmap();
+			return false;
+		}
+#else
+		int file = ::open(path, O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			::close(file);
+			return false;
+		}
+		_size = static_cast<size_t>(status.st_size);
+
+		void* mapped = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (mapped == MAP_FAILED)
+			return false;
+		_base = static_cast<const uint8_t*>(mapped);
+#endif
+		return true;
+	}
+
+	void unmap()
+	{
+#ifdef _WIN32
+		if (_base != nullptr)
+			UnmapViewOfFile(_base);
+		if (_mapping != nullptr)
+			CloseHandle(_mapping);
+		if (_file != INVALID_HANDLE_VALUE)
+			CloseHandle(_file);
+		_mapping = nullptr;
+		_file = INVALID_HANDLE_VALUE;
+#else
+		if (_base != nullptr)
+			munmap(const_cast<uint8_t*>(_base), _size);
+#endif
+		_base = nullptr;
+		_size = 0;
+	}
+
+#ifdef _WIN32
+	HANDLE _file = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+#endif
+	JobPool* _jobs = nullptr;
+	const uint8_t* _base = nullptr;
+	size_t _size = 0;
+	const PackEntry* _entries = nullptr;
+	uint32_t _entryCount = 0;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+//Ⱦ
+//Դ仯ʱǼ򲢵ݰ汾,ûʱҪȾ
+//ÿŽͼƬ¼Լݰ汾,汾һµͼƬֱ³
+class DamageTracker
+{
+public:
+	void reset(uint32_t imageCount, VkExtent2D extent)
+	{
+		_extent = extent;
+		_imageVersions.assign(imageCount, 0);
+		_hasDamage = false;
+		invalidate();
+	}
+
+	//涼ҪȾ
+	void invalidate()
+	{
+		VkRect2D rect = {};
+		rect.extent = _extent;
+		addDamage(rect);
+	}
+
+	void addDamage(const VkRect2D& rect)
+	{
+		int32_t x0 = std::max(rect.offset.x, 0);
+		int32_t y0 = std::max(rect.offset.y, 0);
+		int32_t x1 = std::min(rect.offset.x + static_cast<int32_t>(rect.extent.width),
+			static_cast<int32_t>(_extent.width));
+		int32_t y1 = std::min(rect.offset.y + static_cast<int32_t>(rect.extent.height),
+			static_cast<int32_t>(_extent.height));
+		if (x1 <= x0 || y1 <= y0)
+			return;
+
+		if (_hasDamage)
+		{
+			x0 = std::min(x0, _damage.offset.x);
+			y0 = std::min(y0, _damage.offset.y);
+			x1 = std::max(x1, _damage.offset.x + static_cast<int32_t>(_damage.extent.width));
+			y1 = std::max(y1, _damage.offset.y + static_cast<int32_t>(_damage.extent.height));
+		}
+
+		_damage.offset = { x0, y0 };
+		_damage.extent = { static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0) };
+		_hasDamage = true;
+		++_contentVersion;
+	}
+
+	bool hasDamage() const
+	{
+		return _hasDamage;
+	}
+
+	//ͼƬ,ԲȾֱӳ
+	bool isCurrent(uint32_t imageIndex) const
+	{
+		return imageIndex < _imageVersions.size()
+			&& _imageVersions[imageIndex] == _contentVersion;
+	}
+
+	//ͼƬȾɺ,һγֵ
+	VkRect2D commit(uint32_t imageIndex)
+	{
+		VkRect2D damage = _damage;
+		if (imageIndex < _imageVersions.size())
+			_imageVersions[imageIndex] = _contentVersion;
+
+		_damage = {};
+		_hasDamage = false;
+		return damage;
+	}
+
+private:
+	VkExtent2D _extent = {};
+	VkRect2D _damage = {};
+	bool _hasDamage = false;
+	//1ʼ,ͼƬİ汾0Զ
+	uint64_t _contentVersion = 1;
+	std::vector<uint64_t> _imageVersions;
+};
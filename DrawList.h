@@ -0,0 +1,215 @@
+#pragma once
+
+#include "JobPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//64λ,Ӹλλ: pass(4) | pipeline(12) | material(16) | mesh(16) | depth(16)
+//¼ʱ,ԽǰֶлԽ,ԴԽߵ״̬Խߵλ
+const uint32_t SORT_KEY_PASS_BITS = 4;
+const uint32_t SORT_KEY_PIPELINE_BITS = 12;
+const uint32_t SORT_KEY_MATERIAL_BITS = 16;
+const uint32_t SORT_KEY_MESH_BITS = 16;
+const uint32_t SORT_KEY_DEPTH_BITS = 16;
+
+//depthǹһ[0,1]ӿռ,͸ɽԶ;ҪԶʱ1-depth
+inline uint64_t makeSortKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth)
+{
+	const uint32_t depthMax = (1u << SORT_KEY_DEPTH_BITS) - 1;
+	uint64_t quantizedDepth = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * depthMax + 0.5f);
+
+	uint64_t key = pass & ((1u << SORT_KEY_PASS_BITS) - 1);
+	key = (key << SORT_KEY_PIPELINE_BITS) | (pipeline & ((1u << SORT_KEY_PIPELINE_BITS) - 1));
+	key = (key << SORT_KEY_MATERIAL_BITS) | (material & ((1u << SORT_KEY_MATERIAL_BITS) - 1));
+	key = (key << SORT_KEY_MESH_BITS) | (mesh & ((1u << SORT_KEY_MESH_BITS) - 1));
+	key = (key << SORT_KEY_DEPTH_BITS) | quantizedDepth;
+	return key;
+}
+
+struct SortEntry
+{
+	uint64_t key;
+	uint32_t index;
+};
+
+//LSD,ÿ8λ,ȶ;мĳһ˵ֽڶͬʱ
+//Ԫ㹻ʱ鲢: ͳֱͼ,ٰ(Ͱ,)˳дλ,鲢зַ
+//ڹִ̳߳,߳Ҳ,ʱ֮֡临,ȶٷ
+class RadixSorter
+{
+public:
+	static constexpr uint32_t DigitBits = 8;
+	static constexpr uint32_t BucketCount = 1u << DigitBits;
+	static constexpr uint32_t PassCount = 64 / DigitBits;
+	//ڸʱ߳,̻߳ѵĿ
+	static constexpr size_t ParallelThreshold = 16 * 1024;
+
+	//û̳߳ʱڵ߳
+	void setJobPool(JobPool* jobs)
+	{
+		_jobs = jobs;
+	}
+
+	void sort(std::vector<SortEntry>& entries)
+	{
+		size_t count = entries.size();
+		if (count < 2)
+			return;
+
+		uint32_t chunkCount = 1;
+		if (count >= ParallelThreshold)
+		{
+			uint32_t workerCount = _jobs != nullptr ? _jobs->workerCount() : 0;
+			chunkCount = static_cast<uint32_t>(std::min<size_t>(workerCount + 1, count / (ParallelThreshold / 4)));
+		}
+		size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+		_scratch.resize(count);
+		_chunkCounts.resize(chunkCount);
+		_digitCounts.resize(chunkCount);
+
+		//ֽڵֲв,Ȳͳһ,Ч
+		SortEntry* source = entries.data();
+		runTasks(chunkCount, [&](uint32_t chunk)
+		{
+			auto& counts = _digitCounts[chunk];
+			for (auto& digit : counts)
+				digit.fill(0);
+
+			size_t end = std::min(count, (chunk + 1) * chunkSize);
+			for (size_t i = chunk * chunkSize; i < end; ++i)
+			{
+				uint64_t key = source[i].key;
+				for (uint32_t pass = 0; pass < PassCount; ++pass)
+				{
+					++counts[pass][(key >> (pass * DigitBits)) & (BucketCount - 1)];
+				}
+			}
+		});
+
+		SortEntry* destination = _scratch.data();
+		for (uint32_t pass = 0; pass < PassCount; ++pass)
+		{
+			uint32_t shift = pass * DigitBits;
+			uint32_t firstDigit = (source[0].key >> shift) & (BucketCount - 1);
+			size_t sameDigit = 0;
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				sameDigit += _digitCounts[chunk][pass][firstDigit];
+			}
+			if (sameDigit == count)
+				continue;
+
+			runTasks(chunkCount, [&](uint32_t chunk)
+			{
+				auto& counts = _chunkCounts[chunk];
+				counts.fill(0);
+				size_t end = std::min(count, (chunk + 1) * chunkSize);
+				for (size_t i = chunk * chunkSize; i < end; ++i)
+				{
+					++counts[(source[i].key >> shift) & (BucketCount - 1)];
+				}
+			});
+
+			//ͬһͰ,СĿǰ,֤ȶ
+			size_t offset = 0;
+			for (uint32_t bucket = 0; bucket < BucketCount; ++bucket)
+			{
+				for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+				{
+					size_t bucketCount = _chunkCounts[chunk][bucket];
+					_chunkCounts[chunk][bucket] = static_cast<uint32_t>(offset);
+					offset += bucketCount;
+				}
+			}
+
+			runTasks(chunkCount, [&](uint32_t chunk)
+			{
+				auto& offsets = _chunkCounts[chunk];
+				size_t end = std::min(count, (chunk + 1) * chunkSize);
+				for (size_t i = chunk * chunkSize; i < end; ++i)
+				{
+					destination[offsets[(source[i].key >> shift) & (BucketCount - 1)]++] = source[i];
+				}
+			});
+
+			std::swap(source, destination);
+		}
+
+		//ʱʱvector,
+		if (source != entries.data())
+		{
+			entries.swap(_scratch);
+		}
+	}
+
+private:
+	//taskCountָ̳߳غ͵߳,ȫɺ󷵻
+	void runTasks(uint32_t taskCount, const std::function<void(uint32_t)>& task)
+	{
+		if (_jobs == nullptr || taskCount <= 1)
+		{
+			for (uint32_t i = 0; i < taskCount; ++i)
+			{
+				task(i);
+			}
+			return;
+		}
+		_jobs->parallelFor(taskCount, task);
+	}
+
+	std::vector<SortEntry> _scratch;
+	std::vector<std::array<uint32_t, BucketCount>> _chunkCounts;
+	std::vector<std::array<std::array<uint32_t, BucketCount>, PassCount>> _digitCounts;
+
+	JobPool* _jobs = nullptr;
+};
+
+//ÿ֡Ļб,Draw¼һλҪ
+//ֻƶ16ֽڵ(,±),ԭ
+template<typename Draw>
+class DrawList
+{
+public:
+	//vector֮֡䱣
+	void clear()
+	{
+		_entries.clear();
+		_draws.clear();
+	}
+
+	void add(uint64_t key, const Draw& draw)
+	{
+		_entries.push_back({ key, static_cast<uint32_t>(_draws.size()) });
+		_draws.push_back(draw);
+	}
+
+	void sort(RadixSorter& sorter)
+	{
+		sorter.sort(_entries);
+	}
+
+	size_t size() const
+	{
+		return _entries.size();
+	}
+
+	uint64_t key(size_t i) const
+	{
+		return _entries[i].key;
+	}
+
+	//ĵi
+	const Draw& operator[](size_t i) const
+	{
+		return _draws[_entries[i].index];
+	}
+
+private:
+	std::vector<SortEntry> _entries;
+	std::vector<Draw> _draws;
+};
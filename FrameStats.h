@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+//-ԷͰֱͼ,HdrHistogramͬ˼·
+//С128ֵȷ¼,֮ÿ2ֳ64Ͱ,1/64
+//ֵĵλɵ߾,ͳһʹ΢
+class HdrHistogram
+{
+public:
+	static constexpr uint32_t LinearBuckets = 128;
+	static constexpr uint32_t SubBuckets = 64;
+	static constexpr uint32_t MaxExponent = 34;
+	static constexpr uint32_t BucketCount = LinearBuckets + MaxExponent * SubBuckets;
+
+	void record(uint64_t value)
+	{
+		++_buckets[bucketIndex(value)];
+		++_count;
+		_max = std::max(_max, value);
+		_sum += value;
+	}
+
+	void add(const HdrHistogram& other)
+	{
+		for (uint32_t i = 0; i < BucketCount; ++i)
+		{
+			_buckets[i] += other._buckets[i];
+		}
+		_count += other._count;
+		_max = std::max(_max, other._max);
+		_sum += other._sum;
+	}
+
+	void reset()
+	{
+		_buckets.fill(0);
+		_count = 0;
+		_max = 0;
+		_sum = 0;
+	}
+
+	//percentileȡ0100
+	uint64_t percentile(double percentile) const
+	{
+		if (_count == 0)
+			return 0;
+
+		uint64_t target = static_cast<uint64_t>(std::ceil(percentile / 100.0 * _count));
+		target = std::max<uint64_t>(target, 1);
+
+		uint64_t accumulated = 0;
+		for (uint32_t i = 0; i < BucketCount; ++i)
+		{
+			accumulated += _buckets[i];
+			if (accumulated >= target)
+				return std::min(bucketMiddle(i), _max);
+		}
+		return _max;
+	}
+
+	uint64_t count() const
+	{
+		return _count;
+	}
+
+	uint64_t max() const
+	{
+		return _max;
+	}
+
+	double mean() const
+	{
+		return _count == 0 ? 0.0 : static_cast<double>(_sum) / _count;
+	}
+
+private:
+	static uint32_t highestBit(uint64_t value)
+	{
+		uint32_t bit = 0;
+		while (value >>= 1)
+			++bit;
+		return bit;
+	}
+
+	static uint32_t bucketIndex(uint64_t value)
+	{
+		if (value < LinearBuckets)
+			return static_cast<uint32_t>(value);
+
+		//value >> exponent[64,128)
+		uint32_t exponent = std::min(highestBit(value) - 6, MaxExponent);
+		uint64_t mantissa = std::min<uint64_t>(value >> exponent, 2 * SubBuckets - 1);
+		return LinearBuckets + (exponent - 1) * SubBuckets + static_cast<uint32_t>(mantissa - SubBuckets);
+	}
+
+	static uint64_t bucketMiddle(uint32_t index)
+	{
+		if (index < LinearBuckets)
+			return index;
+
+		uint32_t offset = index - LinearBuckets;
+		uint32_t exponent = offset / SubBuckets + 1;
+		uint64_t lowest = static_cast<uint64_t>(offset % SubBuckets + SubBuckets) << exponent;
+		return lowest + (uint64_t(1) << exponent) / 2;
+	}
+
+	std::array<uint64_t, BucketCount> _buckets = {};
+	uint64_t _count = 0;
+	uint64_t _max = 0;
+	uint64_t _sum = 0;
+};
+
+//ֱͼ,ɸʱƬ,ɵʱƬֻ
+class RollingHistogram
+{
+public:
+	static constexpr uint32_t SliceCount = 10;
+
+	void record(uint64_t value)
+	{
+		_slices[_current].record(value);
+	}
+
+	void rotate()
+	{
+		_current = (_current + 1) % SliceCount;
+		_slices[_current].reset();
+	}
+
+	HdrHistogram merged() const
+	{
+		HdrHistogram result;
+		for (const auto& slice : _slices)
+		{
+			result.add(slice);
+		}
+		return result;
+	}
+
+private:
+	std::array<HdrHistogram, SliceCount> _slices;
+	uint32_t _current = 0;
+};
+
+enum FrameMetric
+{
+	FRAME_METRIC_INTERVAL,
+	FRAME_METRIC_CPU,
+	FRAME_METRIC_GPU,
+	FRAME_METRIC_FENCE_WAIT,
+	FRAME_METRIC_PRESENT_LATENCY,
+	//׶εGPUʱ
+	FRAME_METRIC_POST_LUMINANCE,
+	FRAME_METRIC_POST_BLOOM,
+	FRAME_METRIC_POST_TONEMAP,
+	FRAME_METRIC_COUNT
+};
+
+//֡ʱͳ: ֱͼ(hitch)Ͷ(stutter),Լ/CSV/JSON
+class FrameStats
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	FrameStats() : _sliceStart(Clock::now()) {}
+
+	void record(FrameMetric metric, double milliseconds)
+	{
+		if (milliseconds < 0.0)
+			return;
+		_histograms[metric].record(static_cast<uint64_t>(milliseconds * 1000.0));
+	}
+
+	//γ֮ļ,ͬʱ⿨ٺͶ
+	void recordFrameInterval(double milliseconds)
+	{
+		double median = _medianInterval;
+		if (median > 0.0)
+		{
+			//λ֡һο
+			if (milliseconds > 2.0 * median)
+				++_hitches;
+
+			//֡̽,ƫλһ,һζ
+			double delta = milliseconds - _previousInterval;
+			if (std::abs(delta) > 0.5 * median && std::abs(_previousDelta) > 0.5 * median
+				&& (delta > 0.0) != (_previousDelta > 0.0))
+			{
+				++_stutters;
+			}
+			_previousDelta = delta;
+		}
+		_previousInterval = milliseconds;
+		++_frames;
+
+		record(FRAME_METRIC_INTERVAL, milliseconds);
+	}
+
+	//ÿֻһʱƬ,trueʾͳѸ
+	bool update()
+	{
+		auto now = Clock::now();
+		if (now - _sliceStart < std::chrono::seconds(1))
+			return false;
+
+		_sliceStart = now;
+		_medianInterval = _histograms[FRAME_METRIC_INTERVAL].merged().percentile(50.0) / 1000.0;
+		for (auto& histogram : _histograms)
+		{
+			histogram.rotate();
+		}
+		return true;
+	}
+
+	HdrHistogram histogram(FrameMetric metric) const
+	{
+		return _histograms[metric].merged();
+	}
+
+	uint64_t hitches() const
+	{
+		return _hitches;
+	}
+
+	uint64_t stutters() const
+	{
+		return _stutters;
+	}
+
+	//ϵļҪ
+	std::string summary() const
+	{
+		HdrHistogram interval = histogram(FRAME_METRIC_INTERVAL);
+		HdrHistogram gpu = histogram(FRAME_METRIC_GPU);
+		HdrHistogram latency = histogram(FRAME_METRIC_PRESENT_LATENCY);
+
+		double post = (histogram(FRAME_METRIC_POST_LUMINANCE).percentile(50.0)
+			+ histogram(FRAME_METRIC_POST_BLOOM).percentile(50.0)
+			+ histogram(FRAME_METRIC_POST_TONEMAP).percentile(50.0)) / 1000.0;
+
+		char text[256];
+		snprintf(text, sizeof(text),
+			"frame %.2fms p50 %.2fms p99 | cpu %.2fms | gpu %.2fms post %.2fms | latency %.2fms | hitches %llu stutters %llu",
+			interval.percentile(50.0) / 1000.0, interval.percentile(99.0) / 1000.0,
+			histogram(FRAME_METRIC_CPU).percentile(50.0) / 1000.0,
+			gpu.percentile(50.0) / 1000.0, post, latency.percentile(50.0) / 1000.0,
+			static_cast<unsigned long long>(_hitches), static_cast<unsigned long long>(_stutters));
+		return text;
+	}
+
+	//ÿε׷һ,ļΪʱдͷ
+	bool appendCsv(const char* path) const
+	{
+		std::ifstream existing(path);
+		bool writeHeader = !existing.good() || existing.peek() == std::ifstream::traits_type::eof();
+		existing.close();
+
+		std::ofstream file(path, std::ios::out | std::ios::app);
+		if (!file.is_open())
+			return false;
+
+		if (writeHeader)
+		{
+			file << "timestamp,frames,hitches,stutters";
+			for (uint32_t i = 0; i < FRAME_METRIC_COUNT; ++i)
+			{
+				file << ',' << metricName(i) << "_p50_ms," << metricName(i) << "_p90_ms,"
+					<< metricName(i) << "_p99_ms," << metricName(i) << "_max_ms";
+			}
+			file << '\n';
+		}
+
+		file << timestamp() << ',' << _frames << ',' << _hitches << ',' << _stutters;
+		for (uint32_t i = 0; i < FRAME_METRIC_COUNT; ++i)
+		{
+			HdrHistogram h = histogram(static_cast<FrameMetric>(i));
+			file << ',' << h.percentile(50.0) / 1000.0 << ',' << h.percentile(90.0) / 1000.0
+				<< ',' << h.percentile(99.0) / 1000.0 << ',' << h.max() / 1000.0;
+		}
+		file << '\n';
+		return true;
+	}
+
+	//дµĿ
+	bool writeJson(const char* path) const
+	{
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		file << "{\"timestamp\":" << timestamp() << ",\"frames\":" << _frames
+			<< ",\"hitches\":" << _hitches << ",\"stutters\":" << _stutters << ",\"metrics\":{";
+		for (uint32_t i = 0; i < FRAME_METRIC_COUNT; ++i)
+		{
+			HdrHistogram h = histogram(static_cast<FrameMetric>(i));
+			file << (i == 0 ? "" : ",") << '"' << metricName(i) << "\":{\"count\":" << h.count()
+				<< ",\"mean_ms\":" << h.mean() / 1000.0
+				<< ",\"p50_ms\":" << h.percentile(50.0) / 1000.0
+				<< ",\"p90_ms\":" << h.percentile(90.0) / 1000.0
+				<< ",\"p99_ms\":" << h.percentile(99.0) / 1000.0
+				<< ",\"p999_ms\":" << h.percentile(99.9) / 1000.0
+				<< ",\"max_ms\":" << h.max() / 1000.0 << '}';
+		}
+		file << "}}\n";
+		return true;
+	}
+
+private:
+	static const char* metricName(uint32_t metric)
+	{
+		static const char* names[FRAME_METRIC_COUNT] = {
+			"frame_interval", "cpu", "gpu", "fence_wait", "present_latency",
+			"post_luminance", "post_bloom", "post_tonemap"
+		};
+		return names[metric];
+	}
+
+	static long long timestamp()
+	{
+		return static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count());
+	}
+
+	std::array<RollingHistogram, FRAME_METRIC_COUNT> _histograms;
+	Clock::time_point _sliceStart;
+	double _medianInterval = 0.0;
+	double _previousInterval = 0.0;
+	double _previousDelta = 0.0;
+	uint64_t _frames = 0;
+	uint64_t _hitches = 0;
+	uint64_t _stutters = 0;
+};
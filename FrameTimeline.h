@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+//VK_KHR_timeline_semaphoreGPUʱ
+//ÿύһֵ,κϵͳøֵѯ/ȴӦύǷ
+class FrameTimeline
+{
+public:
+	void create(VkDevice device)
+	{
+		_device = device;
+
+		_vkWaitSemaphores = (PFN_vkWaitSemaphoresKHR)
+			vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+		_vkGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)
+			vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR");
+
+		if (_vkWaitSemaphores == nullptr || _vkGetSemaphoreCounterValue == nullptr)
+		{
+			throw std::runtime_error("failed to load timeline semaphore functions!");
+		}
+
+		VkSemaphoreTypeCreateInfoKHR typeInfo = {};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_semaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create timeline semaphore!");
+		}
+
+		_lastSubmittedValue = 0;
+		_completedValue = 0;
+	}
+
+	void destroy()
+	{
+		if (_semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(_device, _semaphore, nullptr);
+			_semaphore = VK_NULL_HANDLE;
+		}
+	}
+
+	VkSemaphore semaphore() const
+	{
+		return _semaphore;
+	}
+
+	//һύҪsignalֵ,ֻύ̵߳
+	uint64_t nextValue()
+	{
+		return ++_lastSubmittedValue;
+	}
+
+	uint64_t lastSubmittedValue() const
+	{
+		return _lastSubmittedValue;
+	}
+
+	//GPUѾɵֵ
+	uint64_t completedValue()
+	{
+		uint64_t value = 0;
+		if (_vkGetSemaphoreCounterValue(_device, _semaphore, &value) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to query timeline semaphore!");
+		}
+
+		updateCompleted(value);
+		return _completedValue;
+	}
+
+	bool isComplete(uint64_t value)
+	{
+		if (value <= _completedValue)
+			return true;
+
+		return value <= completedValue();
+	}
+
+	//ֻvalueΪֹ,ʱfalse
+	bool wait(uint64_t value,
+		uint64_t timeout = std::numeric_limits<uint64_t>::max())
+	{
+		if (isComplete(value))
+			return true;
+
+		VkSemaphoreWaitInfoKHR waitInfo = {};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &_semaphore;
+		waitInfo.pValues = &value;
+
+		VkResult result = _vkWaitSemaphores(_device, &waitInfo, timeout);
+		if (result == VK_TIMEOUT)
+			return false;
+
+		if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to wait for timeline semaphore!");
+		}
+
+		updateCompleted(value);
+		return true;
+	}
+
+private:
+	void updateCompleted(uint64_t value)
+	{
+		uint64_t completed = _completedValue.load(std::memory_order_relaxed);
+		while (value > completed &&
+			!_completedValue.compare_exchange_weak(completed, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	VkDevice _device = VK_NULL_HANDLE;
+	VkSemaphore _semaphore = VK_NULL_HANDLE;
+	std::atomic<uint64_t> _lastSubmittedValue{ 0 };
+	std::atomic<uint64_t> _completedValue{ 0 };
+	PFN_vkWaitSemaphoresKHR _vkWaitSemaphores = nullptr;
+	PFN_vkGetSemaphoreCounterValueKHR _vkGetSemaphoreCounterValue = nullptr;
+};
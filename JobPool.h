@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//ڹĹ̳߳,Դѹ͹߱붼ύ
+//submit̨,parallelForһָ̺߳͵߳,ȫɺ󷵻
+class JobPool
+{
+public:
+	using Job = std::function<void()>;
+
+	~JobPool()
+	{
+		stop();
+	}
+
+	void start(uint32_t workerCount)
+	{
+		_stopping = false;
+		for (uint32_t i = 0; i < workerCount; ++i)
+		{
+			_workers.emplace_back(&JobPool::workerLoop, this);
+		}
+	}
+
+	//δʼֱӶ,ύҪԼûִе
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+			_queue.clear();
+		}
+		_jobAvailable.notify_all();
+		for (auto& worker : _workers)
+		{
+			worker.join();
+		}
+		_workers.clear();
+	}
+
+	uint32_t workerCount() const
+	{
+		return static_cast<uint32_t>(_workers.size());
+	}
+
+	void submit(Job job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_queue.push_back(std::move(job));
+		}
+		_jobAvailable.notify_one();
+	}
+
+	//߳Ҳȡ,Լʹй̶߳æҲ
+	//Э嵽,ںʱĺ̨;Эûʣֱӷ
+	void parallelFor(uint32_t taskCount, const std::function<void(uint32_t)>& task)
+	{
+		uint32_t helperCount = std::min(workerCount(), taskCount > 0 ? taskCount - 1 : 0);
+		if (helperCount == 0)
+		{
+			for (uint32_t i = 0; i < taskCount; ++i)
+			{
+				task(i);
+			}
+			return;
+		}
+
+		auto batch = std::make_shared<Batch>();
+		batch->task = &task;
+		batch->taskCount = taskCount;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (uint32_t i = 0; i < helperCount; ++i)
+			{
+				_queue.push_front([this, batch] { executeBatch(*batch); });
+			}
+		}
+		_jobAvailable.notify_all();
+
+		executeBatch(*batch);
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_batchDone.wait(lock, [&] { return batch->completed.load() == taskCount; });
+	}
+
+private:
+	//taskֻȡЧ±֮ŷ,parallelForغʧЧ
+	struct Batch
+	{
+		const std::function<void(uint32_t)>* task = nullptr;
+		uint32_t taskCount = 0;
+		std::atomic<uint32_t> nextTask{ 0 };
+		std::atomic<uint32_t> completed{ 0 };
+	};
+
+	void executeBatch(Batch& batch)
+	{
+		for (;;)
+		{
+			uint32_t index = batch.nextTask.fetch_add(1, std::memory_order_relaxed);
+			if (index >= batch.taskCount)
+				break;
+			(*batch.task)(index);
+
+			if (batch.completed.fetch_add(1, std::memory_order_acq_rel) + 1 == batch.taskCount)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_batchDone.notify_all();
+			}
+		}
+	}
+
+	void workerLoop()
+	{
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_jobAvailable.wait(lock, [this] { return _stopping || !_queue.empty(); });
+				if (_stopping)
+					return;
+				job = std::move(_queue.front());
+				_queue.pop_front();
+			}
+
+			job();
+		}
+	}
+
+	std::vector<std::thread> _workers;
+	std::mutex _mutex;
+	std::condition_variable _jobAvailable;
+	std::condition_variable _batchDone;
+	std::deque<Job> _queue;
+	bool _stopping = false;
+};
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+enum class LogSeverity : uint8_t
+{
+	Verbose,
+	Info,
+	Warning,
+	Error
+};
+
+//첽־
+//ֻ߳ؼ˺һ,ʽȥءдstderrں̨߳
+//ʱֱӶ,߳Զ
+class Logger
+{
+public:
+	static Logger& instance()
+	{
+		static Logger logger;
+		return logger;
+	}
+
+	~Logger()
+	{
+		stop();
+	}
+
+	void start()
+	{
+		if (_running.exchange(true))
+			return;
+		_writerThread = std::thread(&Logger::writerLoop, this);
+	}
+
+	//дʣϢ̨߳
+	void stop()
+	{
+		if (!_running.exchange(false))
+			return;
+		if (_writerThread.joinable())
+			_writerThread.join();
+	}
+
+	void setMinSeverity(LogSeverity severity)
+	{
+		_minSeverity.store(static_cast<uint8_t>(severity), std::memory_order_relaxed);
+	}
+
+	//ÿд,0ʾ
+	void setRateLimit(uint32_t linesPerSecond)
+	{
+		_rateLimit.store(linesPerSecond, std::memory_order_relaxed);
+	}
+
+	//messageIdͬϢᱻȥ,0ʾûID,ıȥ
+	void log(LogSeverity severity, int32_t messageId, const char* text)
+	{
+		if (static_cast<uint8_t>(severity) < _minSeverity.load(std::memory_order_relaxed))
+			return;
+
+		//: ռһλ,д󷢲
+		size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;)
+		{
+			slot = &_slots[position & (QueueCapacity - 1)];
+			size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (difference == 0)
+			{
+				if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else
+			{
+				position = _enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->severity = severity;
+		slot->messageId = messageId;
+		size_t length = std::min(strlen(text), MaxMessageLength - 1);
+		memcpy(slot->text, text, length);
+		slot->text[length] = '\0';
+		slot->sequence.store(position + 1, std::memory_order_release);
+	}
+
+private:
+	static constexpr size_t QueueCapacity = 4096;
+	static constexpr size_t MaxMessageLength = 512;
+
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		LogSeverity severity;
+		int32_t messageId;
+		char text[MaxMessageLength];
+	};
+
+	struct DedupEntry
+	{
+		int32_t messageId = 0;
+		uint64_t suppressed = 0;
+		std::chrono::steady_clock::time_point windowStart;
+	};
+
+	Logger()
+	{
+		for (size_t i = 0; i < QueueCapacity; ++i)
+		{
+			_slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	Logger(const Logger&) = delete;
+	Logger& operator=(const Logger&) = delete;
+
+	//߳
+	bool pop(LogSeverity& severity, int32_t& messageId, std::string& text)
+	{
+		Slot& slot = _slots[_dequeuePosition & (QueueCapacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != _dequeuePosition + 1)
+			return false;
+
+		severity = slot.severity;
+		messageId = slot.messageId;
+		text.assign(slot.text);
+		slot.sequence.store(_dequeuePosition + QueueCapacity, std::memory_order_release);
+		++_dequeuePosition;
+		return true;
+	}
+
+	void writerLoop()
+	{
+		std::string batch;
+		std::string text;
+		for (;;)
+		{
+			bool running = _running.load(std::memory_order_acquire);
+			auto now = std::chrono::steady_clock::now();
+
+			LogSeverity severity;
+			int32_t messageId;
+			while (pop(severity, messageId, text))
+			{
+				process(severity, messageId, text, now, batch);
+			}
+
+			flushSuppressed(now, !running, batch);
+
+			uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped > 0)
+			{
+				batch += "[logger] " + std::to_string(dropped) + " messages dropped, queue full\n";
+			}
+
+			//ÿֻдһstderr
+			if (!batch.empty())
+			{
+				fwrite(batch.data(), 1, batch.size(), stderr);
+				fflush(stderr);
+				batch.clear();
+			}
+
+			if (!running)
+				break;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+
+	void process(LogSeverity severity, int32_t messageId, const std::string& text,
+		std::chrono::steady_clock::time_point now, std::string& batch)
+	{
+		//ظϢֻ,ڽʱһλ
+		uint64_t key = messageId != 0 ? static_cast<uint32_t>(messageId) : hashText(text);
+		auto it = _dedup.find(key);
+		if (it != _dedup.end() && now - it->second.windowStart < DedupWindow)
+		{
+			++it->second.suppressed;
+			return;
+		}
+
+		if (!allowLine(now))
+			return;
+
+		DedupEntry& entry = _dedup[key];
+		entry.messageId = messageId;
+		entry.windowStart = now;
+		entry.suppressed = 0;
+
+		batch += severityName(severity);
+		batch += text;
+		batch += '\n';
+	}
+
+	void flushSuppressed(std::chrono::steady_clock::time_point now, bool force, std::string& batch)
+	{
+		for (auto it = _dedup.begin(); it != _dedup.end();)
+		{
+			if (!force && now - it->second.windowStart < DedupWindow)
+			{
+				++it;
+				continue;
+			}
+
+			if (it->second.suppressed > 0)
+			{
+				batch += "[logger] message " + std::to_string(it->second.messageId) +
+					" repeated " + std::to_string(it->second.suppressed) + " times\n";
+			}
+			it = _dedup.erase(it);
+		}
+
+		if (_rateLimited > 0 && (force || now - _rateWindowStart >= std::chrono::seconds(1)))
+		{
+			batch += "[logger] " + std::to_string(_rateLimited) + " messages suppressed by rate limit\n";
+			_rateLimited = 0;
+		}
+	}
+
+	bool allowLine(std::chrono::steady_clock::time_point now)
+	{
+		uint32_t limit = _rateLimit.load(std::memory_order_relaxed);
+		if (now - _rateWindowStart >= std::chrono::seconds(1))
+		{
+			_rateWindowStart = now;
+			_linesInWindow = 0;
+		}
+
+		if (limit != 0 && _linesInWindow >= limit)
+		{
+			++_rateLimited;
+			return false;
+		}
+
+		++_linesInWindow;
+		return true;
+	}
+
+	static uint64_t hashText(const std::string& text)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : text)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static const char* severityName(LogSeverity severity)
+	{
+		switch (severity)
+		{
+		case LogSeverity::Verbose: return "[verbose] ";
+		case LogSeverity::Info: return "[info] ";
+		case LogSeverity::Warning: return "[warning] ";
+		default: return "[error] ";
+		}
+	}
+
+	static constexpr std::chrono::seconds DedupWindow = std::chrono::seconds(1);
+
+	std::array<Slot, QueueCapacity> _slots;
+	alignas(64) std::atomic<size_t> _enqueuePosition{ 0 };
+	alignas(64) size_t _dequeuePosition = 0;
+	std::atomic<uint64_t> _dropped{ 0 };
+	std::atomic<uint8_t> _minSeverity{ static_cast<uint8_t>(LogSeverity::Verbose) };
+	std::atomic<uint32_t> _rateLimit{ 0 };
+	std::atomic<bool> _running{ false };
+	std::thread _writerThread;
+
+	//ֻں̷̨߳
+	std::unordered_map<uint64_t, DedupEntry> _dedup;
+	std::chrono::steady_clock::time_point _rateWindowStart;
+	uint32_t _linesInWindow = 0;
+	uint64_t _rateLimited = 0;
+};
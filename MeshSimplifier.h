@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+//ڶ(QEM),ֻµ,LODԭʼ
+//ÿΰһ۵ڵĶ(۵),ƶԭʼƽƽ͵ƽ,
+//Сʵʵļƫ
+//ű߽硢αߺӷϵĶ,UVӷ첻ᱻƻ
+class MeshSimplifier
+{
+public:
+	//positionStridefloatΪλ,indicesϸһб
+	MeshSimplifier(const float* positions, size_t positionStride, uint32_t vertexCount,
+		const std::vector<uint32_t>& indices)
+		: _positions(positions)
+		, _positionStride(positionStride)
+		, _quadrics(vertexCount)
+		, _canonical(vertexCount)
+		, _locked(vertexCount, false)
+	{
+		//λͬĶͬһζ,һʱ˵UV߽ӷ
+		std::map<std::array<float, 3>, uint32_t> positionMap;
+		std::vector<uint32_t> positionUses(vertexCount, 0);
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			const float* p = position(v);
+			_canonical[v] = positionMap.emplace(std::array<float, 3>{ p[0], p[1], p[2] }, v).first->second;
+			++positionUses[_canonical[v]];
+		}
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			_locked[v] = positionUses[_canonical[v]] > 1;
+		}
+
+		//ֻһ(߽)()ʹõı,
+		std::map<std::pair<uint32_t, uint32_t>, uint32_t> edgeUses;
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			addTriangleQuadric(indices[t], indices[t + 1], indices[t + 2]);
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t a = _canonical[indices[t + k]];
+				uint32_t b = _canonical[indices[t + (k + 1) % 3]];
+				++edgeUses[std::minmax(a, b)];
+			}
+		}
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				uint32_t a = indices[t + k];
+				uint32_t b = indices[t + (k + 1) % 3];
+				if (edgeUses[std::minmax(_canonical[a], _canonical[b])] != 2)
+				{
+					_locked[a] = true;
+					_locked[b] = true;
+				}
+			}
+		}
+	}
+
+	//indicesϼ,ֱtargetIndexCount,һ۵maxError
+	//𼶱ֵLOD,صĿǰΪֹ۵е
+	float simplify(std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError)
+	{
+		double maxErrorSquared = double(maxError) * maxError;
+		uint32_t vertexCount = static_cast<uint32_t>(_quadrics.size());
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		std::vector<Collapse> collapses;
+
+		while (indices.size() > targetIndexCount)
+		{
+			buildAdjacency(indices);
+
+			//ÿǺѡ,۴С
+			collapses.clear();
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				uint32_t from = indices[i];
+				uint32_t to = indices[i - i % 3 + (i + 1) % 3];
+				if (!_locked[from])
+					collapses.push_back({ from, to, collapseCost(from, to) });
+				if (!_locked[to])
+					collapses.push_back({ to, from, collapseCost(to, from) });
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+			{
+				return a.cost < b.cost;
+			});
+
+			//һÿһ۵,źõĴۺͷתűЧ
+			for (uint32_t v = 0; v < vertexCount; ++v)
+			{
+				remap[v] = v;
+			}
+			std::fill(touched.begin(), touched.end(), false);
+
+			size_t triangleCount = indices.size() / 3;
+			size_t targetTriangles = targetIndexCount / 3;
+			bool collapsed = false;
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.cost > maxErrorSquared || triangleCount <= targetTriangles)
+					break;
+				if (touched[collapse.from] || touched[collapse.to])
+					continue;
+
+				size_t removed = 0;
+				if (!canCollapse(indices, remap, collapse.from, collapse.to, removed))
+					continue;
+
+				remap[collapse.from] = collapse.to;
+				touched[collapse.from] = true;
+				touched[collapse.to] = true;
+				addQuadric(_quadrics[_canonical[collapse.to]], _quadrics[_canonical[collapse.from]]);
+				_errorSquared = std::max(_errorSquared, collapse.cost);
+				triangleCount -= removed;
+				collapsed = true;
+			}
+
+			if (!collapsed)
+				break;
+
+			//۵ͬһλõ˻,ֱɾ
+			size_t write = 0;
+			for (size_t t = 0; t < indices.size(); t += 3)
+			{
+				uint32_t a = remap[indices[t]];
+				uint32_t b = remap[indices[t + 1]];
+				uint32_t c = remap[indices[t + 2]];
+				if (_canonical[a] == _canonical[b] || _canonical[b] == _canonical[c] || _canonical[a] == _canonical[c])
+					continue;
+				indices[write++] = a;
+				indices[write++] = b;
+				indices[write++] = c;
+			}
+			indices.resize(write);
+		}
+
+		return static_cast<float>(std::sqrt(_errorSquared));
+	}
+
+private:
+	//Գ4x4
+	struct Quadric
+	{
+		double a2 = 0, ab = 0, ac = 0, ad = 0;
+		double b2 = 0, bc = 0, bd = 0;
+		double c2 = 0, cd = 0;
+		double d2 = 0;
+	};
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+
+	const float* position(uint32_t v) const
+	{
+		return _positions + v * _positionStride;
+	}
+
+	static void addQuadric(Quadric& q, const Quadric& other)
+	{
+		q.a2 += other.a2; q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+		q.b2 += other.b2; q.bc += other.bc; q.bd += other.bd;
+		q.c2 += other.c2; q.cd += other.cd;
+		q.d2 += other.d2;
+	}
+
+	static double evaluate(const Quadric& q, const float* p)
+	{
+		double x = p[0], y = p[1], z = p[2];
+		double error = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z
+			+ 2 * (q.ab * x * y + q.ac * x * z + q.bc * y * z)
+			+ 2 * (q.ad * x + q.bd * y + q.cd * z) + q.d2;
+		return std::max(error, 0.0);
+	}
+
+	static std::array<double, 3> triangleNormal(const float* p0, const float* p1, const float* p2)
+	{
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		return { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+	}
+
+	//ƽӵļζ(_canonical),ӷĶ㹲ͬһƽ
+	void addTriangleQuadric(uint32_t i0, uint32_t i1, uint32_t i2)
+	{
+		const float* p0 = position(i0);
+		std::array<double, 3> n = triangleNormal(p0, position(i1), position(i2));
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length == 0.0)
+			return;
+
+		double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+		double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+		Quadric plane;
+		plane.a2 = a * a; plane.ab = a * b; plane.ac = a * c; plane.ad = a * d;
+		plane.b2 = b * b; plane.bc = b * c; plane.bd = b * d;
+		plane.c2 = c * c; plane.cd = c * d;
+		plane.d2 = d * d;
+		for (uint32_t v : { i0, i1, i2 })
+		{
+			addQuadric(_quadrics[_canonical[v]], plane);
+		}
+	}
+
+	double collapseCost(uint32_t from, uint32_t to) const
+	{
+		Quadric q = _quadrics[_canonical[from]];
+		addQuadric(q, _quadrics[_canonical[to]]);
+		return evaluate(q, position(to));
+	}
+
+	void buildAdjacency(const std::vector<uint32_t>& indices)
+	{
+		uint32_t vertexCount = static_cast<uint32_t>(_quadrics.size());
+		_adjacencyOffset.assign(vertexCount + 1, 0);
+		for (uint32_t index : indices)
+		{
+			++_adjacencyOffset[index + 1];
+		}
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			_adjacencyOffset[v + 1] += _adjacencyOffset[v];
+		}
+		_adjacency.resize(indices.size());
+		std::vector<uint32_t> fill(_adjacencyOffset.begin(), _adjacencyOffset.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			_adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	//fromƶܷת߱ù,removedǻ˻ɾ
+	bool canCollapse(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap,
+		uint32_t from, uint32_t to, size_t& removed) const
+	{
+		removed = 0;
+		for (uint32_t a = _adjacencyOffset[from]; a < _adjacencyOffset[from + 1]; ++a)
+		{
+			uint32_t triangle = _adjacency[a];
+			uint32_t corners[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				corners[k] = remap[indices[triangle * 3 + k]];
+			}
+			if (_canonical[corners[0]] == _canonical[to] || _canonical[corners[1]] == _canonical[to]
+				|| _canonical[corners[2]] == _canonical[to])
+			{
+				++removed;
+				continue;
+			}
+
+			std::array<double, 3> before = triangleNormal(position(corners[0]), position(corners[1]), position(corners[2]));
+			for (uint32_t& corner : corners)
+			{
+				if (corner == from)
+					corner = to;
+			}
+			std::array<double, 3> after = triangleNormal(position(corners[0]), position(corners[1]), position(corners[2]));
+
+			//תԼ75Ͼ;ܾ
+			double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+			double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+				* (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+			if (dot <= 0.25 * lengths)
+				return false;
+		}
+		return true;
+	}
+
+	const float* _positions;
+	size_t _positionStride;
+	std::vector<Quadric> _quadrics;
+	std::vector<uint32_t> _canonical;
+	std::vector<bool> _locked;
+	std::vector<uint32_t> _adjacencyOffset;
+	std::vector<uint32_t> _adjacency;
+	double _errorSquared = 0.0;
+};
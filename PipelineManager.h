@@ -0,0 +1,155 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "JobPool.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//getصĹߺеı,˹ߵı0
+struct PipelineVariant
+{
+	VkPipeline pipeline;
+	uint32_t id;
+};
+
+//߱: StateһȫȾ״̬,ĹϣΪkey
+//һĳʱŽ,ɹ̳߳ϵıȡ,֮ǰgetػ˹,
+//ƲΪȴ;ʧܵıһֱʹû˹
+//ͬʱеı񲻳startʱ,̳߳ص߳ÿ֡Ĳ
+template<typename State>
+class PipelineManager
+{
+public:
+	//buildڹ߳ϵ,VK_NULL_HANDLEʾʧ
+	using BuildFunction = std::function<VkPipeline(const State&)>;
+
+	~PipelineManager()
+	{
+		stop();
+	}
+
+	void start(JobPool& jobs, uint32_t maxCompileJobs, BuildFunction build)
+	{
+		_jobs = &jobs;
+		_maxCompileJobs = maxCompileJobs;
+		_build = std::move(build);
+		_stopping = false;
+	}
+
+	//δʼıֱӶ,ύıȫ˳,̳֮߳ؿڱֹͣ
+	void stop()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_stopping = true;
+		_queue.clear();
+		_idle.wait(lock, [this] { return _compileJobs == 0; });
+	}
+
+	//˹ȷб,ֻû״̬ػ
+	void setFallback(VkPipeline fallback)
+	{
+		_fallback = fallback;
+	}
+
+	PipelineVariant get(uint64_t key, const State& state)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _variants.find(key);
+		if (it == _variants.end())
+		{
+			Variant variant = {};
+			variant.state = state;
+			variant.id = _nextId++;
+			it = _variants.emplace(key, variant).first;
+			_queue.push_back(key);
+			//̳߳ûй߳ʱԶ,ύ,һֱʹû˹
+			if (!_stopping && _compileJobs < _maxCompileJobs && _jobs->workerCount() > 0)
+			{
+				++_compileJobs;
+				_jobs->submit([this] { compileLoop(); });
+			}
+		}
+
+		if (it->second.pipeline == VK_NULL_HANDLE)
+			return { _fallback, 0 };
+		return { it->second.pipeline, it->second.id };
+	}
+
+	//ؽǰ: Ŷӵı,ڱ,ѱĹɵ
+	//֮ı尴µȾ״̬±
+	std::vector<VkPipeline> reset()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_queue.clear();
+		_idle.wait(lock, [this] { return _compileJobs == 0; });
+
+		std::vector<VkPipeline> pipelines;
+		for (const auto& variant : _variants)
+		{
+			if (variant.second.pipeline != VK_NULL_HANDLE)
+				pipelines.push_back(variant.second.pipeline);
+		}
+		_variants.clear();
+		_nextId = 1;
+		_fallback = VK_NULL_HANDLE;
+		return pipelines;
+	}
+
+private:
+	struct Variant
+	{
+		State state;
+		VkPipeline pipeline;
+		uint32_t id;
+	};
+
+	//̳߳,еıֱΪ
+	void compileLoop()
+	{
+		for (;;)
+		{
+			uint64_t key;
+			State state;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				//ʱ֪ͨ,stopغ󱾶
+				if (_queue.empty())
+				{
+					--_compileJobs;
+					_idle.notify_all();
+					return;
+				}
+				key = _queue.front();
+				_queue.pop_front();
+				state = _variants[key].state;
+			}
+
+			VkPipeline pipeline = _build(state);
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_variants[key].pipeline = pipeline;
+			}
+		}
+	}
+
+	BuildFunction _build;
+	VkPipeline _fallback = VK_NULL_HANDLE;
+	std::unordered_map<uint64_t, Variant> _variants;
+	uint32_t _nextId = 1;
+
+	JobPool* _jobs = nullptr;
+	uint32_t _maxCompileJobs = 0;
+	std::mutex _mutex;
+	std::condition_variable _idle;
+	std::deque<uint64_t> _queue;
+	uint32_t _compileJobs = 0;
+	bool _stopping = false;
+};
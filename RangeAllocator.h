@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+//һռڷ,λɵ߾(ֽ)
+//䰴,ͷʱϲ
+class RangeAllocator
+{
+public:
+	void init(uint32_t capacity)
+	{
+		_capacity = capacity;
+		_used = 0;
+		_freeRanges.clear();
+		if (capacity > 0)
+			_freeRanges[0] = capacity;
+	}
+
+	//״,ռ䲻ʱfalse
+	bool allocate(uint32_t count, uint32_t& offset)
+	{
+		if (count == 0)
+			return false;
+
+		for (auto it = _freeRanges.begin(); it != _freeRanges.end(); ++it)
+		{
+			if (it->second < count)
+				continue;
+
+			offset = it->first;
+			uint32_t remaining = it->second - count;
+			_freeRanges.erase(it);
+			if (remaining > 0)
+				_freeRanges[offset + count] = remaining;
+
+			_used += count;
+			return true;
+		}
+		return false;
+	}
+
+	void free(uint32_t offset, uint32_t count)
+	{
+		if (count == 0)
+			return;
+
+		_used -= count;
+
+		auto next = _freeRanges.lower_bound(offset);
+
+		//ǰһ
+		if (next != _freeRanges.begin())
+		{
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset)
+			{
+				offset = prev->first;
+				count += prev->second;
+				_freeRanges.erase(prev);
+			}
+		}
+
+		//һ
+		if (next != _freeRanges.end() && offset + count == next->first)
+		{
+			count += next->second;
+			_freeRanges.erase(next);
+		}
+
+		_freeRanges[offset] = count;
+	}
+
+	uint32_t capacity() const
+	{
+		return _capacity;
+	}
+
+	uint32_t used() const
+	{
+		return _used;
+	}
+
+private:
+	uint32_t _capacity = 0;
+	uint32_t _used = 0;
+	std::map<uint32_t, uint32_t> _freeRanges;
+};
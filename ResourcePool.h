@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//Դ,λúɾԶʧЧ
+template<typename Tag>
+struct Handle
+{
+	uint32_t index = 0;
+	uint32_t generation = 0;
+
+	bool valid() const
+	{
+		return generation != 0;
+	}
+
+	bool operator==(const Handle& other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator!=(const Handle& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+template<typename Tag, typename T>
+class HandlePool
+{
+public:
+	Handle<Tag> allocate(const T& value)
+	{
+		uint32_t index;
+		if (!_freeList.empty())
+		{
+			index = _freeList.back();
+			_freeList.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(_slots.size());
+			_slots.emplace_back();
+		}
+
+		Slot& slot = _slots[index];
+		slot.value = value;
+		slot.alive = true;
+		++_liveCount;
+
+		Handle<Tag> handle;
+		handle.index = index;
+		handle.generation = slot.generation;
+		return handle;
+	}
+
+	//ʧЧʱnullptr
+	T* get(Handle<Tag> handle)
+	{
+		if (handle.index >= _slots.size())
+			return nullptr;
+
+		Slot& slot = _slots[handle.index];
+		if (!slot.alive || slot.generation != handle.generation)
+			return nullptr;
+
+		return &slot.value;
+	}
+
+	const T* get(Handle<Tag> handle) const
+	{
+		return const_cast<HandlePool*>(this)->get(handle);
+	}
+
+	T& operator[](Handle<Tag> handle)
+	{
+		T* value = get(handle);
+		if (value == nullptr)
+		{
+			throw std::runtime_error("stale resource handle!");
+		}
+		return *value;
+	}
+
+	//ƳԴ,λһ,֮Ա
+	T release(Handle<Tag> handle)
+	{
+		T* value = get(handle);
+		if (value == nullptr)
+		{
+			throw std::runtime_error("stale resource handle!");
+		}
+
+		Slot& slot = _slots[handle.index];
+		T released = std::move(slot.value);
+		slot.value = T();
+		slot.alive = false;
+		//0,֤ĬϹľԶЧ
+		if (++slot.generation == 0)
+			slot.generation = 1;
+
+		_freeList.push_back(handle.index);
+		--_liveCount;
+		return released;
+	}
+
+	template<typename F>
+	void forEach(F&& func)
+	{
+		for (uint32_t i = 0; i < _slots.size(); ++i)
+		{
+			if (_slots[i].alive)
+			{
+				Handle<Tag> handle;
+				handle.index = i;
+				handle.generation = _slots[i].generation;
+				func(handle, _slots[i].value);
+			}
+		}
+	}
+
+	size_t size() const
+	{
+		return _liveCount;
+	}
+
+private:
+	struct Slot
+	{
+		T value = T();
+		uint32_t generation = 1;
+		bool alive = false;
+	};
+
+	std::vector<Slot> _slots;
+	std::vector<uint32_t> _freeList;
+	size_t _liveCount = 0;
+};
+
+//ӳٶ,һʹԴʱֵ
+//ʱֵɺ,ʱͷԴҪvkDeviceWaitIdle
+class DeferredDestructionQueue
+{
+public:
+	void push(uint64_t timelineValue, std::function<void()> destroy)
+	{
+		//ύֵ,ֱ׷ӵĩβ
+		auto it = _entries.end();
+		while (it != _entries.begin() && std::prev(it)->timelineValue > timelineValue)
+		{
+			--it;
+		}
+		_entries.insert(it, Entry{ timelineValue, std::move(destroy) });
+	}
+
+	void collect(uint64_t completedValue)
+	{
+		while (!_entries.empty() && _entries.front().timelineValue <= completedValue)
+		{
+			Entry entry = std::move(_entries.front());
+			_entries.pop_front();
+			entry.destroy();
+		}
+	}
+
+	//豸к,ʣԴ
+	void flush()
+	{
+		collect(UINT64_MAX);
+	}
+
+	size_t size() const
+	{
+		return _entries.size();
+	}
+
+private:
+	struct Entry
+	{
+		uint64_t timelineValue;
+		std::function<void()> destroy;
+	};
+
+	std::deque<Entry> _entries;
+};
@@ -0,0 +1,733 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+//SPIR-Vɫӿ
+struct ShaderVertexInput
+{
+	uint32_t location;
+	VkFormat format;
+};
+
+struct ShaderInterface
+{
+	VkShaderStageFlags stages = 0;
+	std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> sets;
+	std::vector<VkPushConstantRange> pushConstantRanges;
+	std::vector<ShaderVertexInput> vertexInputs;
+
+	std::vector<VkDescriptorSetLayoutBinding> setBindings(uint32_t set) const
+	{
+		auto it = sets.find(set);
+		if (it == sets.end())
+			return {};
+		return it->second;
+	}
+
+	uint32_t setCount() const
+	{
+		return sets.empty() ? 0 : sets.rbegin()->first + 1;
+	}
+
+	//ϲ׶εĽӿ,ͬbindingϲstageFlags
+	void merge(const ShaderInterface& other)
+	{
+		stages |= other.stages;
+
+		for (const auto& set : other.sets)
+		{
+			auto& bindings = sets[set.first];
+			for (const auto& binding : set.second)
+			{
+				auto it = std::find_if(bindings.begin(), bindings.end(),
+					[&](const VkDescriptorSetLayoutBinding& b) { return b.binding == binding.binding; });
+
+				if (it == bindings.end())
+				{
+					bindings.push_back(binding);
+				}
+				else if (it->descriptorType != binding.descriptorType)
+				{
+					throw std::runtime_error("descriptor binding type mismatch between shader stages!");
+				}
+				else
+				{
+					it->stageFlags |= binding.stageFlags;
+					it->descriptorCount = std::max(it->descriptorCount, binding.descriptorCount);
+				}
+			}
+
+			std::sort(bindings.begin(), bindings.end(),
+				[](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+			{
+				return a.binding < b.binding;
+			});
+		}
+
+		//н׶ιһpush constantΧ,ʱʹø÷ΧstageFlags
+		for (const auto& range : other.pushConstantRanges)
+		{
+			if (pushConstantRanges.empty())
+			{
+				pushConstantRanges.push_back(range);
+				continue;
+			}
+
+			VkPushConstantRange& merged = pushConstantRanges[0];
+			uint32_t end = std::max(merged.offset + merged.size, range.offset + range.size);
+			merged.offset = std::min(merged.offset, range.offset);
+			merged.size = end - merged.offset;
+			merged.stageFlags |= range.stageFlags;
+		}
+
+		vertexInputs.insert(vertexInputs.end(),
+			other.vertexInputs.begin(), other.vertexInputs.end());
+	}
+};
+
+namespace spirv
+{
+	const uint32_t MagicNumber = 0x07230203;
+
+	enum Op : uint32_t
+	{
+		OpEntryPoint = 15,
+		OpTypeBool = 20,
+		OpTypeInt = 21,
+		OpTypeFloat = 22,
+		OpTypeVector = 23,
+		OpTypeMatrix = 24,
+		OpTypeImage = 25,
+		OpTypeSampler = 26,
+		OpTypeSampledImage = 27,
+		OpTypeArray = 28,
+		OpTypeRuntimeArray = 29,
+		OpTypeStruct = 30,
+		OpTypePointer = 32,
+		OpConstant = 43,
+		OpVariable = 59,
+		OpDecorate = 71,
+		OpMemberDecorate = 72,
+	};
+
+	enum Decoration : uint32_t
+	{
+		DecorationBlock = 2,
+		DecorationBufferBlock = 3,
+		DecorationArrayStride = 6,
+		DecorationMatrixStride = 7,
+		DecorationBuiltIn = 11,
+		DecorationLocation = 30,
+		DecorationBinding = 33,
+		DecorationDescriptorSet = 34,
+		DecorationOffset = 35,
+	};
+
+	enum StorageClass : uint32_t
+	{
+		StorageClassUniformConstant = 0,
+		StorageClassInput = 1,
+		StorageClassUniform = 2,
+		StorageClassPushConstant = 9,
+		StorageClassStorageBuffer = 12,
+	};
+
+	enum ExecutionModel : uint32_t
+	{
+		ExecutionModelVertex = 0,
+		ExecutionModelTessellationControl = 1,
+		ExecutionModelTessellationEvaluation = 2,
+		ExecutionModelGeometry = 3,
+		ExecutionModelFragment = 4,
+		ExecutionModelGLCompute = 5,
+	};
+
+	enum Dim : uint32_t
+	{
+		DimBuffer = 5,
+		DimSubpassData = 6,
+	};
+}
+
+class ShaderReflector
+{
+public:
+	explicit ShaderReflector(std::span<const uint8_t> code)
+	{
+		if (code.size() < 20 || code.size() % 4 != 0)
+		{
+			throw std::runtime_error("invalid SPIR-V module size!");
+		}
+
+		_words.resize(code.size() / 4);
+		memcpy(_words.data(), code.data(), code.size());
+
+		if (_words[0] != spirv::MagicNumber)
+		{
+			throw std::runtime_error("invalid SPIR-V magic number!");
+		}
+
+		parse();
+	}
+
+	ShaderInterface reflect() const
+	{
+		ShaderInterface shaderInterface;
+		shaderInterface.stages = _stage;
+
+		for (const auto& variable : _variables)
+		{
+			const Id& pointer = id(variable.typeId);
+			uint32_t typeId = pointer.operands.size() > 1 ? pointer.operands[1] : 0;
+			const Id& decorations = id(variable.id);
+
+			switch (variable.storageClass)
+			{
+			case spirv::StorageClassUniformConstant:
+			case spirv::StorageClassUniform:
+			case spirv::StorageClassStorageBuffer:
+			{
+				VkDescriptorSetLayoutBinding binding = {};
+				binding.binding = decorations.binding;
+				binding.descriptorCount = 1;
+				binding.stageFlags = _stage;
+				binding.pImmutableSamplers = nullptr;
+
+				//
+				const Id* type = &id(typeId);
+				if (type->opcode == spirv::OpTypeArray)
+				{
+					binding.descriptorCount = constantValue(type->operands[1]);
+					type = &id(type->operands[0]);
+				}
+				else if (type->opcode == spirv::OpTypeRuntimeArray)
+				{
+					type = &id(type->operands[0]);
+				}
+
+				binding.descriptorType = descriptorType(variable.storageClass, *type);
+				shaderInterface.sets[decorations.descriptorSet].push_back(binding);
+				break;
+			}
+			case spirv::StorageClassPushConstant:
+			{
+				VkPushConstantRange range = {};
+				range.stageFlags = _stage;
+				range.offset = 0;
+				range.size = typeSize(typeId);
+				shaderInterface.pushConstantRanges.push_back(range);
+				break;
+			}
+			case spirv::StorageClassInput:
+			{
+				if (_stage != VK_SHADER_STAGE_VERTEX_BIT || decorations.builtIn || !decorations.hasLocation)
+					break;
+
+				shaderInterface.vertexInputs.push_back({ decorations.location, vertexFormat(typeId) });
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		for (auto& set : shaderInterface.sets)
+		{
+			std::sort(set.second.begin(), set.second.end(),
+				[](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+			{
+				return a.binding < b.binding;
+			});
+		}
+
+		return shaderInterface;
+	}
+
+private:
+	struct Id
+	{
+		uint32_t opcode = 0;
+		std::vector<uint32_t> operands;
+		uint32_t binding = 0;
+		uint32_t descriptorSet = 0;
+		uint32_t location = 0;
+		uint32_t arrayStride = 0;
+		bool hasLocation = false;
+		bool builtIn = false;
+		bool block = false;
+		bool bufferBlock = false;
+		std::vector<uint32_t> memberOffsets;
+		std::vector<uint32_t> memberMatrixStrides;
+	};
+
+	struct Variable
+	{
+		uint32_t id;
+		uint32_t typeId;
+		uint32_t storageClass;
+	};
+
+	void parse()
+	{
+		uint32_t bound = _words[3];
+		_ids.resize(bound);
+
+		size_t offset = 5;
+		while (offset < _words.size())
+		{
+			uint32_t wordCount = _words[offset] >> 16;
+			uint32_t opcode = _words[offset] & 0xffff;
+			if (wordCount == 0 || offset + wordCount > _words.size())
+			{
+				throw std::runtime_error("malformed SPIR-V instruction!");
+			}
+
+			const uint32_t* operands = &_words[offset + 1];
+			uint32_t operandCount = wordCount - 1;
+
+			switch (opcode)
+			{
+			case spirv::OpEntryPoint:
+				_stage = shaderStage(operands[0]);
+				break;
+			case spirv::OpDecorate:
+				decorate(id(operands[0]), operands[1], operandCount > 2 ? operands[2] : 0);
+				break;
+			case spirv::OpMemberDecorate:
+				memberDecorate(id(operands[0]), operands[1], operands[2], operandCount > 3 ? operands[3] : 0);
+				break;
+			case spirv::OpTypeBool:
+			case spirv::OpTypeInt:
+			case spirv::OpTypeFloat:
+			case spirv::OpTypeVector:
+			case spirv::OpTypeMatrix:
+			case spirv::OpTypeImage:
+			case spirv::OpTypeSampler:
+			case spirv::OpTypeSampledImage:
+			case spirv::OpTypeArray:
+			case spirv::OpTypeRuntimeArray:
+			case spirv::OpTypeStruct:
+			case spirv::OpTypePointer:
+			{
+				Id& result = id(operands[0]);
+				result.opcode = opcode;
+				result.operands.assign(operands + 1, operands + operandCount);
+				break;
+			}
+			case spirv::OpConstant:
+			{
+				Id& result = id(operands[1]);
+				result.opcode = opcode;
+				result.operands.assign(operands + 2, operands + operandCount);
+				break;
+			}
+			case spirv::OpVariable:
+				_variables.push_back({ operands[1], operands[0], operands[2] });
+				break;
+			default:
+				break;
+			}
+
+			offset += wordCount;
+		}
+	}
+
+	Id& id(uint32_t index)
+	{
+		if (index >= _ids.size())
+		{
+			throw std::runtime_error("SPIR-V id out of bounds!");
+		}
+		return _ids[index];
+	}
+
+	const Id& id(uint32_t index) const
+	{
+		if (index >= _ids.size())
+		{
+			throw std::runtime_error("SPIR-V id out of bounds!");
+		}
+		return _ids[index];
+	}
+
+	static void decorate(Id& target, uint32_t decoration, uint32_t value)
+	{
+		switch (decoration)
+		{
+		case spirv::DecorationBlock: target.block = true; break;
+		case spirv::DecorationBufferBlock: target.bufferBlock = true; break;
+		case spirv::DecorationArrayStride: target.arrayStride = value; break;
+		case spirv::DecorationBuiltIn: target.builtIn = true; break;
+		case spirv::DecorationLocation: target.location = value; target.hasLocation = true; break;
+		case spirv::DecorationBinding: target.binding = value; break;
+		case spirv::DecorationDescriptorSet: target.descriptorSet = value; break;
+		default: break;
+		}
+	}
+
+	static void memberDecorate(Id& target, uint32_t member, uint32_t decoration, uint32_t value)
+	{
+		if (decoration == spirv::DecorationOffset)
+		{
+			if (target.memberOffsets.size() <= member)
+				target.memberOffsets.resize(member + 1, 0);
+			target.memberOffsets[member] = value;
+		}
+		else if (decoration == spirv::DecorationMatrixStride)
+		{
+			if (target.memberMatrixStrides.size() <= member)
+				target.memberMatrixStrides.resize(member + 1, 0);
+			target.memberMatrixStrides[member] = value;
+		}
+		else if (decoration == spirv::DecorationBuiltIn)
+		{
+			target.builtIn = true;
+		}
+	}
+
+	static VkShaderStageFlagBits shaderStage(uint32_t executionModel)
+	{
+		switch (executionModel)
+		{
+		case spirv::ExecutionModelVertex: return VK_SHADER_STAGE_VERTEX_BIT;
+		case spirv::ExecutionModelTessellationControl: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+		case spirv::ExecutionModelTessellationEvaluation: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		case spirv::ExecutionModelGeometry: return VK_SHADER_STAGE_GEOMETRY_BIT;
+		case spirv::ExecutionModelFragment: return VK_SHADER_STAGE_FRAGMENT_BIT;
+		case spirv::ExecutionModelGLCompute: return VK_SHADER_STAGE_COMPUTE_BIT;
+		default:
+			throw std::runtime_error("unsupported SPIR-V execution model!");
+		}
+	}
+
+	uint32_t constantValue(uint32_t constantId) const
+	{
+		const Id& constant = id(constantId);
+		if (constant.opcode != spirv::OpConstant || constant.operands.empty())
+		{
+			throw std::runtime_error("SPIR-V array length is not a constant!");
+		}
+		return constant.operands[0];
+	}
+
+	VkDescriptorType descriptorType(uint32_t storageClass, const Id& type) const
+	{
+		if (storageClass == spirv::StorageClassStorageBuffer)
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+		if (storageClass == spirv::StorageClassUniform)
+		{
+			return type.bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+				: VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		}
+
+		switch (type.opcode)
+		{
+		case spirv::OpTypeSampler:
+			return VK_DESCRIPTOR_TYPE_SAMPLER;
+		case spirv::OpTypeSampledImage:
+			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		case spirv::OpTypeImage:
+		{
+			//operands: sampled type, dim, depth, arrayed, ms, sampled, format
+			uint32_t dim = type.operands[1];
+			uint32_t sampled = type.operands[5];
+			if (dim == spirv::DimSubpassData)
+				return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			if (dim == spirv::DimBuffer)
+				return sampled == 1 ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER
+					: VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+			return sampled == 1 ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+				: VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		}
+		default:
+			throw std::runtime_error("unsupported SPIR-V descriptor type!");
+		}
+	}
+
+	uint32_t typeSize(uint32_t typeId, uint32_t matrixStride = 0) const
+	{
+		const Id& type = id(typeId);
+		switch (type.opcode)
+		{
+		case spirv::OpTypeBool:
+			return 4;
+		case spirv::OpTypeInt:
+		case spirv::OpTypeFloat:
+			return type.operands[0] / 8;
+		case spirv::OpTypeVector:
+			return typeSize(type.operands[0]) * type.operands[1];
+		case spirv::OpTypeMatrix:
+		{
+			uint32_t columnSize = matrixStride != 0 ? matrixStride : typeSize(type.operands[0]);
+			return columnSize * type.operands[1];
+		}
+		case spirv::OpTypeArray:
+		{
+			uint32_t stride = type.arrayStride != 0 ? type.arrayStride : typeSize(type.operands[0]);
+			return stride * constantValue(type.operands[1]);
+		}
+		case spirv::OpTypeStruct:
+		{
+			uint32_t size = 0;
+			for (size_t i = 0; i < type.operands.size(); ++i)
+			{
+				uint32_t memberOffset = i < type.memberOffsets.size() ? type.memberOffsets[i] : size;
+				uint32_t memberStride = i < type.memberMatrixStrides.size() ? type.memberMatrixStrides[i] : 0;
+				size = std::max(size, memberOffset + typeSize(type.operands[i], memberStride));
+			}
+			return size;
+		}
+		default:
+			return 0;
+		}
+	}
+
+	VkFormat vertexFormat(uint32_t typeId) const
+	{
+		const Id& type = id(typeId);
+		uint32_t componentCount = 1;
+		const Id* component = &type;
+		if (type.opcode == spirv::OpTypeVector)
+		{
+			componentCount = type.operands[1];
+			component = &id(type.operands[0]);
+		}
+
+		static const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+			VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+		static const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+			VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+		static const VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+			VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+		if (componentCount < 1 || componentCount > 4)
+			return VK_FORMAT_UNDEFINED;
+
+		if (component->opcode == spirv::OpTypeFloat)
+			return floatFormats[componentCount - 1];
+		if (component->opcode == spirv::OpTypeInt)
+			return component->operands[1] ? intFormats[componentCount - 1] : uintFormats[componentCount - 1];
+
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	std::vector<uint32_t> _words;
+	std::vector<Id> _ids;
+	std::vector<Variable> _variables;
+	VkShaderStageFlagBits _stage = VK_SHADER_STAGE_VERTEX_BIT;
+};
+
+inline ShaderInterface reflectShader(std::span<const uint8_t> code)
+{
+	return ShaderReflector(code).reflect();
+}
+
+inline void hashCombine(size_t& seed, size_t value)
+{
+	seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+//bindingȥصֻ
+class DescriptorSetLayoutCache
+{
+public:
+	void init(VkDevice device)
+	{
+		_device = device;
+	}
+
+	VkDescriptorSetLayout get(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		Key key = { bindings };
+		auto it = _layouts.find(key);
+		if (it != _layouts.end())
+			return it->second;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		VkDescriptorSetLayout layout;
+		if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr,
+			&layout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create descriptor set layout!");
+		}
+
+		_layouts.emplace(std::move(key), layout);
+		return layout;
+	}
+
+	void destroy()
+	{
+		for (auto& layout : _layouts)
+		{
+			vkDestroyDescriptorSetLayout(_device, layout.second, nullptr);
+		}
+		_layouts.clear();
+	}
+
+private:
+	struct Key
+	{
+		std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+		bool operator==(const Key& other) const
+		{
+			if (bindings.size() != other.bindings.size())
+				return false;
+
+			for (size_t i = 0; i < bindings.size(); ++i)
+			{
+				const auto& a = bindings[i];
+				const auto& b = other.bindings[i];
+				if (a.binding != b.binding || a.descriptorType != b.descriptorType
+					|| a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags
+					|| a.pImmutableSamplers != b.pImmutableSamplers)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const
+		{
+			size_t seed = key.bindings.size();
+			for (const auto& binding : key.bindings)
+			{
+				hashCombine(seed, binding.binding);
+				hashCombine(seed, binding.descriptorType);
+				hashCombine(seed, binding.descriptorCount);
+				hashCombine(seed, binding.stageFlags);
+			}
+			return seed;
+		}
+	};
+
+	VkDevice _device = VK_NULL_HANDLE;
+	std::mutex _mutex;
+	std::unordered_map<Key, VkDescriptorSetLayout, KeyHash> _layouts;
+};
+
+//ϲֺpush constantΧȥصĹֻ߲
+class PipelineLayoutCache
+{
+public:
+	void init(VkDevice device)
+	{
+		_device = device;
+	}
+
+	VkPipelineLayout get(const std::vector<VkDescriptorSetLayout>& setLayouts,
+		const std::vector<VkPushConstantRange>& pushConstantRanges)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		Key key = { setLayouts, pushConstantRanges };
+		auto it = _layouts.find(key);
+		if (it != _layouts.end())
+			return it->second;
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+		VkPipelineLayout layout;
+		if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &layout)
+			!= VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+
+		_layouts.emplace(std::move(key), layout);
+		return layout;
+	}
+
+	//ȡ,ȱʧsetʹÿղ
+	VkPipelineLayout get(DescriptorSetLayoutCache& setLayoutCache,
+		const ShaderInterface& shaderInterface)
+	{
+		std::vector<VkDescriptorSetLayout> setLayouts(shaderInterface.setCount());
+		for (uint32_t i = 0; i < setLayouts.size(); ++i)
+		{
+			setLayouts[i] = setLayoutCache.get(shaderInterface.setBindings(i));
+		}
+
+		return get(setLayouts, shaderInterface.pushConstantRanges);
+	}
+
+	void destroy()
+	{
+		for (auto& layout : _layouts)
+		{
+			vkDestroyPipelineLayout(_device, layout.second, nullptr);
+		}
+		_layouts.clear();
+	}
+
+private:
+	struct Key
+	{
+		std::vector<VkDescriptorSetLayout> setLayouts;
+		std::vector<VkPushConstantRange> pushConstantRanges;
+
+		bool operator==(const Key& other) const
+		{
+			if (setLayouts != other.setLayouts
+				|| pushConstantRanges.size() != other.pushConstantRanges.size())
+				return false;
+
+			for (size_t i = 0; i < pushConstantRanges.size(); ++i)
+			{
+				const auto& a = pushConstantRanges[i];
+				const auto& b = other.pushConstantRanges[i];
+				if (a.stageFlags != b.stageFlags || a.offset != b.offset || a.size != b.size)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const
+		{
+			size_t seed = key.setLayouts.size();
+			for (auto layout : key.setLayouts)
+			{
+				hashCombine(seed, std::hash<VkDescriptorSetLayout>()(layout));
+			}
+			for (const auto& range : key.pushConstantRanges)
+			{
+				hashCombine(seed, range.stageFlags);
+				hashCombine(seed, range.offset);
+				hashCombine(seed, range.size);
+			}
+			return seed;
+		}
+	};
+
+	VkDevice _device = VK_NULL_HANDLE;
+	std::mutex _mutex;
+	std::unordered_map<Key, VkPipelineLayout, KeyHash> _layouts;
+};
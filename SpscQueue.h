@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//ߵߵζ,2
+//ʱpushfalse,ɵ߾
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two!");
+
+public:
+	bool push(const T& value)
+	{
+		size_t head = _head.load(std::memory_order_relaxed);
+		if (head - _tail.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		_items[head & (Capacity - 1)] = value;
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T& value)
+	{
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail == _head.load(std::memory_order_acquire))
+			return false;
+
+		value = _items[tail & (Capacity - 1)];
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<T, Capacity> _items;
+	alignas(64) std::atomic<size_t> _head{ 0 };
+	alignas(64) std::atomic<size_t> _tail{ 0 };
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+
+//־ӳstagingλ
+//ϴӻз,ύôʱֵ,ֵɺռ䱻
+class StagingRing
+{
+public:
+	void init(VkBuffer buffer, void* mapped, VkDeviceSize capacity)
+	{
+		_buffer = buffer;
+		_data = static_cast<uint8_t*>(mapped);
+		_capacity = capacity;
+		_head = 0;
+		_tail = 0;
+		_retiredHead = 0;
+		_retired.clear();
+	}
+
+	VkBuffer buffer() const
+	{
+		return _buffer;
+	}
+
+	uint8_t* data() const
+	{
+		return _data;
+	}
+
+	VkDeviceSize capacity() const
+	{
+		return _capacity;
+	}
+
+	//alignment2capacity,ռ䲻ʱfalse
+	bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+	{
+		if (size > _capacity)
+			return false;
+
+		VkDeviceSize head = (_head + alignment - 1) & ~(alignment - 1);
+		VkDeviceSize position = head % _capacity;
+
+		//ŲʱĿͷ
+		if (position + size > _capacity)
+			head += _capacity - position;
+
+		if (head + size - _tail > _capacity)
+			return false;
+
+		offset = head % _capacity;
+		_head = head + size;
+		return true;
+	}
+
+	//ϴretire֮Ŀռ䶼ύ
+	void retire(uint64_t timelineValue)
+	{
+		if (_head == _retiredHead)
+			return;
+
+		_retired.push_back({ timelineValue, _head });
+		_retiredHead = _head;
+	}
+
+	void reclaim(uint64_t completedValue)
+	{
+		while (!_retired.empty() && _retired.front().timelineValue <= completedValue)
+		{
+			_tail = _retired.front().end;
+			_retired.pop_front();
+		}
+	}
+
+	//ѷ䵫ûύֽ
+	VkDeviceSize pendingBytes() const
+	{
+		return _head - _retiredHead;
+	}
+
+	bool hasRetired() const
+	{
+		return !_retired.empty();
+	}
+
+	uint64_t oldestRetiredValue() const
+	{
+		return _retired.empty() ? 0 : _retired.front().timelineValue;
+	}
+
+private:
+	struct Retired
+	{
+		uint64_t timelineValue;
+		VkDeviceSize end;
+	};
+
+	VkBuffer _buffer = VK_NULL_HANDLE;
+	uint8_t* _data = nullptr;
+	VkDeviceSize _capacity = 0;
+	//λ,ȡģõƫ
+	VkDeviceSize _head = 0;
+	VkDeviceSize _tail = 0;
+	VkDeviceSize _retiredHead = 0;
+	std::deque<Retired> _retired;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+//ÿ֡仯Ķ̬(ߡUIβ)ʹõʽ
+//־ӳhost-visible尴ֳ֡,ÿֻ֡дԼ
+//begin֮ǰѾȴ֡λһύ,д벻ḲGPUڶȡ
+//÷: begin(frame) -> append/allocateɴ -> flush() -> ύ
+class StreamBuffer
+{
+public:
+	void init(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, void* mapped,
+		VkDeviceSize regionSize, uint32_t regionCount, bool coherent, VkDeviceSize nonCoherentAtomSize)
+	{
+		_device = device;
+		_buffer = buffer;
+		_memory = memory;
+		_data = static_cast<uint8_t*>(mapped);
+		_regionSize = regionSize;
+		_regionCount = regionCount;
+		_coherent = coherent;
+		_atomSize = nonCoherentAtomSize > 0 ? nonCoherentAtomSize : 1;
+		_regionBegin = 0;
+		_cursor = 0;
+		_flushed = 0;
+	}
+
+	VkBuffer buffer() const
+	{
+		return _buffer;
+	}
+
+	void begin(uint32_t regionIndex)
+	{
+		if (regionIndex >= _regionCount)
+		{
+			throw std::out_of_range("stream buffer region out of range!");
+		}
+
+		_regionBegin = _regionSize * regionIndex;
+		_cursor = _regionBegin;
+		_flushed = _regionBegin;
+	}
+
+	//ڵǰԤռ,ؿֱдӳָ,ʱnullptr
+	//offsetֽƫ
+	void* allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+	{
+		VkDeviceSize aligned = (_cursor + alignment - 1) / alignment * alignment;
+		if (aligned + size > _regionBegin + _regionSize)
+			return nullptr;
+
+		offset = aligned;
+		_cursor = aligned + size;
+		return _data + aligned;
+	}
+
+	//׷countԪ,firstElementsizeof(T)Ϊλ±
+	//ƫ0ʱֱΪvertexOffset/firstIndexʹ
+	template<typename T>
+	bool append(const T* items, uint32_t count, uint32_t& firstElement)
+	{
+		VkDeviceSize offset;
+		void* dst = allocate(sizeof(T) * count, sizeof(T), offset);
+		if (dst == nullptr)
+			return false;
+
+		memcpy(dst, items, sizeof(T) * count);
+		firstElement = static_cast<uint32_t>(offset / sizeof(T));
+		return true;
+	}
+
+	//ʹ֡дGPUɼ,coherentڴ治Ҫκ
+	void flush()
+	{
+		if (!_coherent && _cursor > _flushed)
+		{
+			VkMappedMemoryRange range = {};
+			range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+			range.memory = _memory;
+			range.offset = _flushed / _atomSize * _atomSize;
+			range.size = (_cursor - range.offset + _atomSize - 1) / _atomSize * _atomSize;
+			if (range.offset + range.size > _regionSize * _regionCount)
+				range.size = VK_WHOLE_SIZE;
+
+			vkFlushMappedMemoryRanges(_device, 1, &range);
+		}
+		_flushed = _cursor;
+	}
+
+	VkDeviceSize regionSize() const
+	{
+		return _regionSize;
+	}
+
+	//ǰ֡ʹõֽ
+	VkDeviceSize used() const
+	{
+		return _cursor - _regionBegin;
+	}
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+	VkBuffer _buffer = VK_NULL_HANDLE;
+	VkDeviceMemory _memory = VK_NULL_HANDLE;
+	uint8_t* _data = nullptr;
+	VkDeviceSize _regionSize = 0;
+	uint32_t _regionCount = 0;
+	bool _coherent = true;
+	VkDeviceSize _atomSize = 1;
+	VkDeviceSize _regionBegin = 0;
+	VkDeviceSize _cursor = 0;
+	VkDeviceSize _flushed = 0;
+};
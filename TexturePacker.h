@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+//ѴСϲ2D(ҳ),ֻҪ¼ҳ桢Ӿ
+//ͬʽߴmipռһ
+//߳2ҲmaxAtlasTextureSizeСϲͼ,λðߴ,
+//mip㼶Ӿλص,ѹҲԽ
+struct TexturePackInput
+{
+	uint32_t format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	uint32_t blockWidth;
+	uint32_t blockHeight;
+};
+
+struct TexturePackPage
+{
+	uint32_t format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t layerCount;
+	uint32_t mipCount;
+	bool atlas;
+};
+
+//x,ymip 0еλ,ҳ0
+struct TexturePlacement
+{
+	uint32_t page;
+	uint32_t layer;
+	uint32_t x;
+	uint32_t y;
+};
+
+struct TexturePackLimits
+{
+	//ͼҳ߳,ĬֵVulkan֤maxImageDimension2D
+	uint32_t atlasSize = 2048;
+	uint32_t maxAtlasTextureSize = 512;
+	//ͼҳmip,СͬԹҳ,ԶĲͣһ
+	uint32_t maxAtlasMips = 5;
+	//Vulkan֤maxImageArrayLayersСֵ
+	uint32_t maxLayers = 256;
+};
+
+class TexturePacker
+{
+public:
+	explicit TexturePacker(const TexturePackLimits& limits = TexturePackLimits())
+		: _limits(limits)
+	{
+	}
+
+	uint32_t add(const TexturePackInput& input)
+	{
+		_inputs.push_back(input);
+		return static_cast<uint32_t>(_inputs.size() - 1);
+	}
+
+	//˳±ѯplacement
+	void pack()
+	{
+		_pages.clear();
+		_placements.assign(_inputs.size(), TexturePlacement());
+
+		//map,ͬõͬĽ
+		std::map<std::tuple<uint32_t, uint32_t>, std::vector<uint32_t>> atlasGroups;
+		std::map<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>, std::vector<uint32_t>> arrayGroups;
+		for (uint32_t i = 0; i < _inputs.size(); ++i)
+		{
+			const TexturePackInput& input = _inputs[i];
+			if (fitsAtlas(input))
+			{
+				atlasGroups[std::make_tuple(input.format, atlasMips(input))].push_back(i);
+			}
+			else
+			{
+				arrayGroups[std::make_tuple(input.format, input.width, input.height, input.mipCount)].push_back(i);
+			}
+		}
+
+		for (const auto& group : arrayGroups)
+		{
+			packArray(group.second);
+		}
+		for (const auto& group : atlasGroups)
+		{
+			packAtlas(group.second, std::get<1>(group.first));
+		}
+	}
+
+	const std::vector<TexturePackPage>& pages() const
+	{
+		return _pages;
+	}
+
+	const TexturePlacement& placement(uint32_t index) const
+	{
+		return _placements[index];
+	}
+
+private:
+	static bool isPowerOfTwo(uint32_t value)
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+
+	bool fitsAtlas(const TexturePackInput& input) const
+	{
+		return isPowerOfTwo(input.width) && isPowerOfTwo(input.height)
+			&& input.width <= _limits.maxAtlasTextureSize && input.height <= _limits.maxAtlasTextureSize
+			&& input.width >= input.blockWidth && input.height >= input.blockHeight;
+	}
+
+	//ӾСһѹ֮ǰmipԷŽͼ
+	uint32_t atlasMips(const TexturePackInput& input) const
+	{
+		uint32_t mips = 1;
+		while (mips < input.mipCount && mips < _limits.maxAtlasMips
+			&& (input.width >> mips) >= input.blockWidth && (input.height >> mips) >= input.blockHeight)
+		{
+			++mips;
+		}
+		return mips;
+	}
+
+	void packArray(const std::vector<uint32_t>& members)
+	{
+		const TexturePackInput& first = _inputs[members[0]];
+		for (uint32_t index : members)
+		{
+			if (index == members[0] || _pages.back().layerCount == _limits.maxLayers)
+			{
+				_pages.push_back({ first.format, first.width, first.height, 0, first.mipCount, false });
+			}
+
+			TexturePackPage& page = _pages.back();
+			_placements[index] = { static_cast<uint32_t>(_pages.size() - 1), page.layerCount, 0, 0 };
+			++page.layerCount;
+		}
+	}
+
+	//(shelf)װ: Ȱ߶ٰȽ,ܸ߶2ҵݼ,
+	//yȻ뵽߶,x϶뵽
+	void packAtlas(std::vector<uint32_t> members, uint32_t mipCount)
+	{
+		std::sort(members.begin(), members.end(), [this](uint32_t a, uint32_t b)
+		{
+			if (_inputs[a].height != _inputs[b].height)
+				return _inputs[a].height > _inputs[b].height;
+			if (_inputs[a].width != _inputs[b].width)
+				return _inputs[a].width > _inputs[b].width;
+			return a < b;
+		});
+
+		uint32_t size = _limits.atlasSize;
+		uint32_t cursorX = size;
+		uint32_t shelfY = 0;
+		uint32_t shelfHeight = size;
+		bool newPage = true;
+		for (uint32_t index : members)
+		{
+			const TexturePackInput& input = _inputs[index];
+			uint32_t x = (cursorX + input.width - 1) / input.width * input.width;
+			if (x + input.width > size)
+			{
+				shelfY += shelfHeight;
+				shelfHeight = input.height;
+				x = 0;
+			}
+
+			if (newPage || shelfY + shelfHeight > size)
+			{
+				if (newPage || _pages.back().layerCount == _limits.maxLayers)
+				{
+					_pages.push_back({ input.format, size, size, 0, mipCount, true });
+					newPage = false;
+				}
+				++_pages.back().layerCount;
+				shelfY = 0;
+				shelfHeight = input.height;
+				x = 0;
+			}
+
+			_placements[index] = { static_cast<uint32_t>(_pages.size() - 1), _pages.back().layerCount - 1, x, shelfY };
+			cursorX = x + input.width;
+		}
+
+		//ֻһҳס2ݳߴ,ɢСռͼ
+		for (uint32_t index : members)
+		{
+			TexturePackPage& page = _pages[_placements[index].page];
+			if (page.layerCount == 1 && page.width == size)
+			{
+				page.width = 1;
+				page.height = 1;
+			}
+		}
+		for (uint32_t index : members)
+		{
+			const TexturePlacement& placement = _placements[index];
+			TexturePackPage& page = _pages[placement.page];
+			while (page.layerCount == 1 && page.width < placement.x + _inputs[index].width)
+				page.width *= 2;
+			while (page.layerCount == 1 && page.height < placement.y + _inputs[index].height)
+				page.height *= 2;
+		}
+	}
+
+	TexturePackLimits _limits;
+	std::vector<TexturePackInput> _inputs;
+	std::vector<TexturePackPage> _pages;
+	std::vector<TexturePlacement> _placements;
+};
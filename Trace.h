@@ -0,0 +1,178 @@
+#pragma once
+
+//CPUʱ,Chrome traceʽ(chrome://tracingPerfettoֱӴ)
+//ֻжENABLE_TRACINGʱŻ,к궼ǿյ
+//÷: TRACE_FUNCTION();  TRACE_ZONE("name"); ֱַ
+#ifdef ENABLE_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trace
+{
+	struct Event
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t duration;
+	};
+
+	//ÿ߳һ,¼ʱ,д
+	struct ThreadBuffer
+	{
+		static constexpr size_t Capacity = 256 * 1024;
+
+		uint32_t threadId = 0;
+		std::string threadName;
+		std::unique_ptr<Event[]> events{ new Event[Capacity] };
+		std::atomic<size_t> count{ 0 };
+		std::atomic<uint64_t> dropped{ 0 };
+	};
+
+	class Tracer
+	{
+	public:
+		static Tracer& instance()
+		{
+			static Tracer tracer;
+			return tracer;
+		}
+
+		uint64_t now() const
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - _epoch).count());
+		}
+
+		//̵߳һμ¼ʱע,ֻҪ
+		ThreadBuffer& threadBuffer()
+		{
+			thread_local ThreadBuffer* buffer = nullptr;
+			if (buffer == nullptr)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_buffers.emplace_back(new ThreadBuffer());
+				buffer = _buffers.back().get();
+				buffer->threadId = static_cast<uint32_t>(_buffers.size());
+			}
+			return *buffer;
+		}
+
+		void record(const char* name, uint64_t start, uint64_t end)
+		{
+			ThreadBuffer& buffer = threadBuffer();
+			size_t index = buffer.count.load(std::memory_order_relaxed);
+			if (index >= ThreadBuffer::Capacity)
+			{
+				buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			buffer.events[index] = { name, start, end - start };
+			buffer.count.store(index + 1, std::memory_order_release);
+		}
+
+		void setThreadName(const char* name)
+		{
+			ThreadBuffer& buffer = threadBuffer();
+			std::lock_guard<std::mutex> lock(_mutex);
+			buffer.threadName = name;
+		}
+
+		//߳ڼ¼ʱ,ֻдѾɵ¼
+		//д¼дotherData,̵߳Ķдthread_nameĲ
+		bool dump(const char* path)
+		{
+			std::ofstream file(path, std::ios::out | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			file << "{\"traceEvents\":[\n";
+			bool first = true;
+			uint64_t totalDropped = 0;
+			for (const auto& buffer : _buffers)
+			{
+				uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+				totalDropped += dropped;
+				if (!buffer->threadName.empty() || dropped > 0)
+				{
+					file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+						<< buffer->threadId << ",\"args\":{\"name\":\"" << buffer->threadName
+						<< "\",\"droppedEvents\":" << dropped << "}}";
+					first = false;
+				}
+
+				size_t count = buffer->count.load(std::memory_order_acquire);
+				for (size_t i = 0; i < count; ++i)
+				{
+					const Event& event = buffer->events[i];
+					//Chrome traceʱ䵥λ΢
+					file << (first ? "" : ",\n") << "{\"name\":\"" << event.name
+						<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+						<< ",\"ts\":" << event.start / 1000 << '.' << pad3(event.start % 1000)
+						<< ",\"dur\":" << event.duration / 1000 << '.' << pad3(event.duration % 1000) << "}";
+					first = false;
+				}
+			}
+			file << "\n],\n\"otherData\":{\"droppedEvents\":" << totalDropped << "}}\n";
+			return true;
+		}
+
+	private:
+		Tracer() : _epoch(std::chrono::steady_clock::now()) {}
+
+		static std::string pad3(uint64_t value)
+		{
+			std::string digits = std::to_string(value);
+			return std::string(3 - digits.size(), '0') + digits;
+		}
+
+		std::chrono::steady_clock::time_point _epoch;
+		std::mutex _mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+	};
+
+	class Zone
+	{
+	public:
+		explicit Zone(const char* name)
+			: _name(name), _start(Tracer::instance().now())
+		{
+		}
+
+		~Zone()
+		{
+			Tracer::instance().record(_name, _start, Tracer::instance().now());
+		}
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+	private:
+		const char* _name;
+		uint64_t _start;
+	};
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_ZONE(name) ::trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_FUNCTION() TRACE_ZONE(__FUNCTION__)
+#define TRACE_THREAD_NAME(name) ::trace::Tracer::instance().setThreadName(name)
+#define TRACE_DUMP(path) ::trace::Tracer::instance().dump(path)
+
+#else
+
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_FUNCTION() ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#define TRACE_DUMP(path) ((void)0)
+
+#endif
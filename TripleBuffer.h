@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+//ߵߵ
+//дԼĻ,publishʱм仺彻;updateʱȡµм仺
+//˫ȴԷ,߶һ״̬
+template<typename T>
+class TripleBuffer
+{
+public:
+	//: ǰдĻ,ϴη״̬,Ҫ
+	T& writeBuffer()
+	{
+		return _buffers[_writeIndex];
+	}
+
+	void publish()
+	{
+		uint8_t previous = _middle.exchange(_writeIndex | DirtyBit, std::memory_order_acq_rel);
+		_writeIndex = previous & IndexMask;
+	}
+
+	//: ״̬ʱ岢true
+	bool update()
+	{
+		if ((_middle.load(std::memory_order_relaxed) & DirtyBit) == 0)
+			return false;
+
+		uint8_t previous = _middle.exchange(_readIndex, std::memory_order_acq_rel);
+		_readIndex = previous & IndexMask;
+		return true;
+	}
+
+	const T& readBuffer() const
+	{
+		return _buffers[_readIndex];
+	}
+
+private:
+	static constexpr uint8_t IndexMask = 0x3;
+	static constexpr uint8_t DirtyBit = 0x4;
+
+	std::array<T, 3> _buffers;
+	//ߺ߸Ե±ڲͬĻ,α
+	alignas(64) uint8_t _writeIndex = 0;
+	alignas(64) std::atomic<uint8_t> _middle{ 1 };
+	alignas(64) uint8_t _readIndex = 2;
+};
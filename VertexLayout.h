@@ -0,0 +1,183 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+//Դ洢,ÿͶӦһVkFormat
+//Ͷ4ֽڶ,˳ʱṹû
+struct Float2
+{
+	Float2() = default;
+	Float2(float x, float y) : value(x, y) {}
+	Float2(const glm::vec2& v) : value(v) {}
+
+	glm::vec2 value;
+};
+
+struct Float3
+{
+	Float3() = default;
+	Float3(float x, float y, float z) : value(x, y, z) {}
+	Float3(const glm::vec3& v) : value(v) {}
+
+	glm::vec3 value;
+};
+
+struct Float4
+{
+	Float4() = default;
+	Float4(float x, float y, float z, float w) : value(x, y, z, w) {}
+	Float4(const glm::vec4& v) : value(v) {}
+
+	glm::vec4 value;
+};
+
+//뾫λ/
+struct Half2
+{
+	Half2() = default;
+	Half2(float x, float y) : bits(glm::packHalf2x16(glm::vec2(x, y))) {}
+	Half2(const glm::vec2& v) : bits(glm::packHalf2x16(v)) {}
+
+	glm::vec2 unpack() const { return glm::unpackHalf2x16(bits); }
+
+	uint32_t bits = 0;
+};
+
+struct Half4
+{
+	Half4() = default;
+	Half4(float x, float y, float z, float w) : Half4(glm::vec4(x, y, z, w)) {}
+	Half4(const glm::vec4& v)
+		: low(glm::packHalf2x16(glm::vec2(v.x, v.y)))
+		, high(glm::packHalf2x16(glm::vec2(v.z, v.w))) {}
+
+	uint32_t low = 0;
+	uint32_t high = 0;
+};
+
+//8λһɫ
+struct UNorm8x4
+{
+	UNorm8x4() = default;
+	UNorm8x4(float r, float g, float b, float a = 1.0f)
+		: bits(glm::packUnorm4x8(glm::vec4(r, g, b, a))) {}
+	UNorm8x4(const glm::vec3& c) : bits(glm::packUnorm4x8(glm::vec4(c, 1.0f))) {}
+	UNorm8x4(const glm::vec4& c) : bits(glm::packUnorm4x8(c)) {}
+
+	uint32_t bits = 0;
+};
+
+//ӳ䷨,16λsnorm
+//shaderн: n = vec3(e, 1-|e.x|-|e.y|); if(n.z<0) n.xy = (1-|n.yx|)*sign(n.xy); normalize(n)
+struct OctNormal
+{
+	OctNormal() = default;
+	OctNormal(float x, float y, float z) : OctNormal(glm::vec3(x, y, z)) {}
+	OctNormal(const glm::vec3& n) : bits(glm::packSnorm2x16(encode(n))) {}
+
+	static glm::vec2 encode(glm::vec3 n)
+	{
+		n /= (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+		glm::vec2 e(n.x, n.y);
+		if (n.z < 0.0f)
+		{
+			e = glm::vec2(
+				(1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+		}
+		return e;
+	}
+
+	static glm::vec3 decode(glm::vec2 e)
+	{
+		glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+		if (n.z < 0.0f)
+		{
+			n.x = (1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+			n.y = (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+		}
+		return glm::normalize(n);
+	}
+
+	uint32_t bits = 0;
+};
+
+template<typename T>
+struct VertexAttributeFormat;
+
+template<> struct VertexAttributeFormat<Float2> { static constexpr VkFormat value = VK_FORMAT_R32G32_SFLOAT; };
+template<> struct VertexAttributeFormat<Float3> { static constexpr VkFormat value = VK_FORMAT_R32G32B32_SFLOAT; };
+template<> struct VertexAttributeFormat<Float4> { static constexpr VkFormat value = VK_FORMAT_R32G32B32A32_SFLOAT; };
+template<> struct VertexAttributeFormat<Half2> { static constexpr VkFormat value = VK_FORMAT_R16G16_SFLOAT; };
+template<> struct VertexAttributeFormat<Half4> { static constexpr VkFormat value = VK_FORMAT_R16G16B16A16_SFLOAT; };
+template<> struct VertexAttributeFormat<UNorm8x4> { static constexpr VkFormat value = VK_FORMAT_R8G8B8A8_UNORM; };
+template<> struct VertexAttributeFormat<OctNormal> { static constexpr VkFormat value = VK_FORMAT_R16G16_SNORM; };
+
+template<uint32_t Location, typename T>
+struct VertexAttribute
+{
+	static constexpr uint32_t location = Location;
+	static constexpr VkFormat format = VertexAttributeFormat<T>::value;
+	static constexpr uint32_t size = sizeof(T);
+	using Type = T;
+};
+
+//бڱbinding/attribute
+//ṹ밴ͬ˳Щ,static_assertstrideÿԵoffset
+template<uint32_t Binding, typename... Attributes>
+struct VertexLayout
+{
+	static constexpr uint32_t binding = Binding;
+	static constexpr uint32_t attributeCount = sizeof...(Attributes);
+	static constexpr uint32_t stride = (0 + ... + Attributes::size);
+
+	//indexڶеƫ,֮ǰԴС֮
+	static constexpr uint32_t offset(uint32_t index)
+	{
+		constexpr uint32_t sizes[] = { Attributes::size... };
+
+		uint32_t result = 0;
+		for (uint32_t i = 0; i < index; ++i)
+		{
+			result += sizes[i];
+		}
+
+		return result;
+	}
+
+	static constexpr VkVertexInputBindingDescription getBindingDescription(
+		VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+	{
+		VkVertexInputBindingDescription bindingDescription = {};
+		bindingDescription.binding = Binding;
+		bindingDescription.stride = stride;
+		bindingDescription.inputRate = inputRate;
+
+		return bindingDescription;
+	}
+
+	static constexpr std::array<VkVertexInputAttributeDescription, attributeCount> getAttributeDescriptions()
+	{
+		constexpr uint32_t locations[] = { Attributes::location... };
+		constexpr VkFormat formats[] = { Attributes::format... };
+
+		std::array<VkVertexInputAttributeDescription, attributeCount> attributeDescriptions = {};
+
+		for (uint32_t i = 0; i < attributeCount; ++i)
+		{
+			attributeDescriptions[i].binding = Binding;
+			attributeDescriptions[i].location = locations[i];
+			attributeDescriptions[i].format = formats[i];
+			attributeDescriptions[i].offset = offset(i);
+		}
+
+		return attributeDescriptions;
+	}
+};
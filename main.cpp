@@ -6,13 +6,11 @@
 #define  GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
 #define  GLM_FORCE_RANIANS
 #define  GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include<glm/gtc/matrix_transform.hpp>
+#include<glm/gtc/constants.hpp>
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
 
@@ -25,18 +23,131 @@
 #include <fstream>
 #include<array>
 #include<chrono>
+#include<deque>
+#include<random>
+#include<thread>
+#include<atomic>
+#include<span>
+#include<unordered_map>
+
+#include "FrameTimeline.h"
+#include "VertexLayout.h"
+#include "ShaderReflection.h"
+#include "ResourcePool.h"
+#include "StagingRing.h"
+#include "RangeAllocator.h"
+#include "StreamBuffer.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "DamageTracker.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "FrameStats.h"
+#include "JobPool.h"
+#include "AssetPack.h"
+#include "DrawList.h"
+#include "PipelineManager.h"
 
 
 const int WIDTH = 800;
 const int HEIGHT = 600;
 const int MAX_FRAMES_IN_FLIGHT = 2;
+//MSAA,豸ʱȡ豸ֵ
+const VkSampleCountFlagBits MSAA_SAMPLES = VK_SAMPLE_COUNT_4_BIT;
+//ϴõstagingС,ϴᱻ
+const VkDeviceSize STAGING_RING_SIZE = 16 * 1024 * 1024;
+const VkDeviceSize STAGING_ALIGNMENT = 16;
+//λ,λֱǶ
+const uint32_t GEOMETRY_VERTEX_CAPACITY = 1024 * 1024;
+const uint32_t GEOMETRY_INDEX_CAPACITY = 4 * 1024 * 1024;
+//ÿ֡Ķ̬С
+const VkDeviceSize DYNAMIC_GEOMETRY_REGION_SIZE = 16 * 1024 * 1024;
+//GPU,particle.compĹС
+const uint32_t PARTICLE_COUNT = 1024 * 1024;
+const uint32_t PARTICLE_WORKGROUP_SIZE = 256;
+//ģ̵߳Ĺ̶,󳬹ʱ׷
+const double SIMULATION_TIMESTEP = 1.0 / 120.0;
+const uint32_t MAX_SIMULATION_STEPS = 8;
+//Ⱦ: ûб仯ʱȴ¼,ǳȾ
+const bool enableOnDemandRendering = true;
+const double ON_DEMAND_WAIT_TIMEOUT = 0.1;
+//־ÿд,ظϢⰴIDȥ
+const uint32_t LOG_RATE_LIMIT = 200;
+//֡ͳÿˢһα,ÿдһCSV/JSON
+const double FRAME_STATS_DUMP_INTERVAL = 10.0;
+const char* const FRAME_STATS_CSV_PATH = "frame_stats.csv";
+const char* const FRAME_STATS_JSON_PATH = "frame_stats.json";
+//γֵּΪȾĿ,֡
+const double FRAME_STATS_IDLE_THRESHOLD = 0.25;
+//presentID¼acquireʱĻαС
+const uint32_t PRESENT_HISTORY_SIZE = 64;
+//asset_cook決Դ,ִļͬһĿ¼
+const char* const ASSET_PACK_PATH = "assets.pack";
+//ҳ,pixel.fragеMAX_TEXTURE_PAGESһ
+const uint32_t MAX_TEXTURE_PAGES = 8;
+//ͶӰĽԶƽ,еҲһΧ
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 10.0f;
+//еpassֶ,͸ҪԶpassں
+const uint32_t DRAW_PASS_OPAQUE = 0;
+//̬β,еֶʹֵ,ھ̬֮
+const uint32_t DYNAMIC_MESH_KEY = (1u << SORT_KEY_MESH_BITS) - 1;
+//ÿ֡建ͼ
+const uint32_t MAX_DRAW_OBJECTS = 4096;
+const float CAMERA_FOV_DEGREES = 45.0f;
+//LODļͶӰĻϲʱʹøֵһ
+const float LOD_ERROR_THRESHOLD = 1.0f;
+//лֵһʱҪֵ(1-LOD_HYSTERESIS),ֵ֡л
+const float LOD_HYSTERESIS = 0.25f;
+//ֶεĵλLOD㼶,ͬһͬһ㼶Ļ,Ժϲʵ
+const uint32_t SORT_KEY_LOD_BITS = 3;
+static_assert((1u << SORT_KEY_LOD_BITS) >= MAX_MESH_LODS, "SORT_KEY_LOD_BITS cannot hold every mesh LOD!");
+//ȾHDRĿ,ɼɫϳɵͼƬ
+const VkFormat HDR_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+//ӳɫ: subpass 0ѲɫͷдG-buffer,subpass 1Ϊinput attachmentȡ
+//G-bufferضȡ,ʱʹMSAA;CMakeѡENABLE_DEFERRED_SHADINGرʱǰȾMSAA
+#ifdef ENABLE_DEFERRED_SHADING
+const bool DEFERRED_SHADING = true;
+#else
+const bool DEFERRED_SHADING = false;
+#endif
+//subpassм,ҲǰƵHDRĿ
+const uint32_t LIGHTING_SUBPASS = DEFERRED_SHADING ? 1 : 0;
+//ɫֵ,sRGBʽ洢,ɫ
+const VkFormat GBUFFER_ALBEDO_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+const VkFormat GBUFFER_NORMAL_FORMAT = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+//մ͹Դ,ص޹
+const uint32_t LIGHT_COUNT = 64;
+//ɫĹPOST_WORKGROUP_SIZE x POST_WORKGROUP_SIZE,post_*.compһ
+const uint32_t POST_WORKGROUP_SIZE = 16;
+//ع󳬹ֵĲֽ뷺
+const float BLOOM_THRESHOLD = 1.0f;
+const float BLOOM_INTENSITY = 0.3f;
+//عĿñʱΪѾ,ڴ֮ǰȾҲ֡
+const float EXPOSURE_CONVERGED_RATIO = 0.01f;
+//ÿ׶εGPUʱԤ,ʱ¼
+const double POST_STAGE_BUDGET_MS = 0.5;
+//ÿ֡ʱ: ֡ʼͳƽ֡
+const uint32_t TIMESTAMP_FRAME_BEGIN = 0;
+const uint32_t TIMESTAMP_SCENE_END = 1;
+const uint32_t TIMESTAMP_LUMINANCE_END = 2;
+const uint32_t TIMESTAMP_BLOOM_END = 3;
+const uint32_t TIMESTAMP_FRAME_END = 4;
+const uint32_t TIMESTAMPS_PER_FRAME = 5;
 
 const std::vector<const char*> validationLayers = {
 		"VK_LAYER_LUNARG_standard_validation"
 };
 
 const std::vector<const char*> deviceExtension = {
-	VK_KHR_SWAPCHAIN_EXTENSION_NAME
+	VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+	VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME
+};
+
+//豸֧ʱõչ
+const std::vector<const char*> optionalDeviceExtension = {
+	VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME,
+	VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME
 };
 
 struct SwapChainSupportDetails
@@ -54,7 +165,16 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
 	void* pUserData
 )
 {
-	std::cerr << "validation layer:" << pCallbackData->pMessage << std::endl;
+	//߳ϵ,ֻ,־߳д
+	LogSeverity severity = LogSeverity::Verbose;
+	if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+		severity = LogSeverity::Error;
+	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+		severity = LogSeverity::Warning;
+	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
+		severity = LogSeverity::Info;
+
+	Logger::instance().log(severity, pCallbackData->messageIdNumber, pCallbackData->pMessage);
 	return VK_FALSE;
 }
 
@@ -70,6 +190,8 @@ struct QueueFamilyIndices
 {
 	int graphicsFamily = -1;
 	int presentFamily = -1;
+	//ѡ֧ͼεĶ,Ҳʱͼζͬ
+	int computeFamily = -1;
 
 	bool isComplete()
 	{
@@ -78,74 +200,281 @@ struct QueueFamilyIndices
 	}
 };
 
-static std::vector<char> readFile(const std::string& filename)
+//뾫λ+8λɫ+뾫,ÿ12ֽ
+struct Vertex
 {
-	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	Half2 pos;
+	UNorm8x4 color;
+	Half2 texCoord;
 
-	if (!file.is_open())
+	using Layout = VertexLayout<0,
+		VertexAttribute<0, Half2>,
+		VertexAttribute<1, UNorm8x4>,
+		VertexAttribute<2, Half2>>;
+
+	static VkVertexInputBindingDescription getBindingDescription()
 	{
-		throw std::runtime_error("failed to open file!");
+		return Layout::getBindingDescription();
 	}
 
-	size_t fileSize = (size_t)file.tellg();
-	std::vector<char> buffer(fileSize);
+	static std::array<VkVertexInputAttributeDescription, Layout::attributeCount> getAttributeDescriptions()
+	{
+		return Layout::getAttributeDescriptions();
+	}
+};
 
-	file.seekg(0);
-	file.read(buffer.data(),fileSize);
-	file.close();
+static_assert(sizeof(Vertex) == Vertex::Layout::stride, "Vertex does not match its layout!");
+static_assert(offsetof(Vertex, pos) == Vertex::Layout::offset(0), "Vertex::pos does not match its layout!");
+static_assert(offsetof(Vertex, color) == Vertex::Layout::offset(1), "Vertex::color does not match its layout!");
+static_assert(offsetof(Vertex, texCoord) == Vertex::Layout::offset(2), "Vertex::texCoord does not match its layout!");
 
-	return buffer;
-}
+const std::vector<Vertex> quadVertices = {
+	{{-0.5f,-0.5f},{1.0f,0.0f,0.0f},{0.0f,0.0f}},
+	{{0.5f,-0.5f},{0.0f,1.0f,0.0f},{1.0f,0.0f}},
+	{{0.5f,0.5f},{0.0f,0.0f,1.0f},{1.0f,1.0f}},
+	{{-0.5f,0.5f},{0.0f,1.0f,1.0f},{0.0f,1.0f}}
+};
 
-struct Vertex
+const std::vector<uint16_t> quadIndices = {
+	0,1,2,2,3,0
+};
+
+const std::vector<Vertex> triangleVertices = {
+	{{0.0f,-0.3f},{1.0f,1.0f,0.0f},{0.5f,0.0f}},
+	{{0.3f,0.3f},{1.0f,0.0f,1.0f},{1.0f,1.0f}},
+	{{-0.3f,0.3f},{1.0f,1.0f,1.0f},{0.0f,1.0f}}
+};
+
+const std::vector<uint16_t> triangleIndices = {
+	0,1,2
+};
+
+struct UniformBufferObject
+{
+	glm::mat4 view;
+	glm::mat4 proj;
+	glm::mat4 viewProj;
+};
+
+//״̬,particle.compеstd430ṹһ
+//ͬһǼɫstorage buffer,ҲǻʱĶ㻺
+struct Particle
 {
-	glm::vec2 pos;
-	glm::vec3 color;
+	Float4 position;
+	Float4 velocity;
 
-	static VkVertexInputBindingDescription getBindingDescription()
-	{
-		VkVertexInputBindingDescription bindingDescription = {};
-		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(Vertex);
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	using Layout = VertexLayout<0,
+		VertexAttribute<0, Float4>,
+		VertexAttribute<1, Float4>>;
+};
 
-		return bindingDescription;
-	}
+static_assert(sizeof(Particle) == Particle::Layout::stride, "Particle does not match its layout!");
+static_assert(offsetof(Particle, position) == Particle::Layout::offset(0), "Particle::position does not match its layout!");
+static_assert(offsetof(Particle, velocity) == Particle::Layout::offset(1), "Particle::velocity does not match its layout!");
 
-	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions()
-	{
-		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions = {};
+struct ParticleParams
+{
+	float deltaTime;
+	float time;
+	uint32_t particleCount;
+};
 
-		attributeDescriptions[0].binding = 0;
-		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(Vertex, pos);
+//lighting.fragеstd430ṹһ,positionRange.wǹշΧ
+struct PointLight
+{
+	glm::vec4 positionRange;
+	glm::vec4 color;
+};
 
-		attributeDescriptions[1].binding = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(Vertex, color);
+//lighting.fragеpush constantһ
+struct LightingParams
+{
+	glm::mat4 invViewProj;
+	glm::vec4 ambient;
+	uint32_t lightCount;
+};
 
-		return attributeDescriptions;
-	}
+//post_*.compõpush constant,һ
+struct PostParams
+{
+	float bloomThreshold;
+	float bloomIntensity;
+	float deltaTime;
+	uint32_t partialCount;
+	int32_t blurDirection[2];
+	uint32_t pixelCount;
+	uint32_t encodeSrgb;
 };
 
-const std::vector<Vertex> vertices = {
-	{{-0.5f,-0.5f},{1.0f,0.0f,0.0f}},
-	{{0.5f,-0.5f},{0.0f,1.0f,0.0f}},
-	{{0.5f,0.5f},{0.0f,0.0f,1.0f}},
-	{{-0.5f,0.5f},{0.0f,1.0f,1.0f}}
+//post_*.compеExposureһ
+struct ExposureState
+{
+	float exposure;
+	float averageLuminance;
+	float targetExposure;
 };
 
-const std::vector<uint16_t> indices = {
-	0,1,2,2,3,0
+//ļ
+enum PostPipeline
+{
+	POST_PIPELINE_DOWNSAMPLE,
+	POST_PIPELINE_EXPOSURE,
+	POST_PIPELINE_BLUR,
+	POST_PIPELINE_TONEMAP,
+	POST_PIPELINE_COUNT
 };
 
-struct UniformBufferObject
+//뽻ͼƬ޹ص
+enum PostDescriptorSet
+{
+	POST_SET_DOWNSAMPLE,
+	POST_SET_EXPOSURE,
+	POST_SET_BLUR_HORIZONTAL,
+	POST_SET_BLUR_VERTICAL,
+	POST_SET_COUNT
+};
+
+//ÿ,vertex.vertеstd430ṹһ
+//¼ʱ˳д建,ɫgl_InstanceIndexȡ
+//normalռ䷨,¼ʱÿһ,materialIndexstd43016ֽڲ
+struct ObjectData
 {
 	glm::mat4 model;
-	glm::mat4 view;
-	glm::mat4 proj;
+	glm::vec3 normal;
+	uint32_t materialIndex;
+};
+
+static_assert(sizeof(ObjectData) == 80, "ObjectData does not match the std430 layout!");
+
+//ʱеһ,pixel.fragеstd430ṹһ
+//uvTransform.xyҳеӾδС,zwƫ
+struct MaterialData
+{
+	glm::vec4 uvTransform;
+	uint32_t page;
+	uint32_t layer;
+	uint32_t flags;
+	uint32_t padding;
+};
+
+//0Ųû,ֻʹöɫ
+const uint32_t MATERIAL_UNTEXTURED = 0;
+const uint32_t MATERIAL_TEXTURED = 1;
+//pixel.fragػMATERIAL_VARIANT: 0ͨñ,ʱȡʱ־;
+//MATERIAL_SPECIALIZEDʱλǱȷĲʱ־,֧ڱʱ
+const uint32_t MATERIAL_SPECIALIZED = 0x80000000u;
+
+//ͼι߱ȫ״̬,ϣΪPipelineManagerkey
+struct GraphicsPipelineState
+{
+	uint32_t materialVariant;
+};
+
+//бVulkanԴ
+struct BufferResource
+{
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize size = 0;
+};
+
+struct ImageResource
+{
+	VkImage image = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkImageView view = VK_NULL_HANDLE;
+};
+
+struct DescriptorSetResource
+{
+	VkDescriptorSet set = VK_NULL_HANDLE;
+	VkDescriptorPool pool = VK_NULL_HANDLE;
+};
+
+//ڹλеλ,vertexOffset
+//LODδ,lodsеfirstIndexfirstIndex
+struct Mesh
+{
+	uint32_t vertexOffset = 0;
+	uint32_t vertexCount = 0;
+	uint32_t firstIndex = 0;
+	uint32_t indexCount = 0;
+	uint32_t lodCount = 0;
+	std::array<MeshLod, MAX_MESH_LODS> lods = {};
+};
+
+struct BufferTag;
+struct ImageTag;
+struct PipelineTag;
+struct DescriptorSetTag;
+struct MeshTag;
+typedef Handle<BufferTag> BufferHandle;
+typedef Handle<ImageTag> ImageHandle;
+typedef Handle<PipelineTag> PipelineHandle;
+typedef Handle<DescriptorSetTag> DescriptorSetHandle;
+typedef Handle<MeshTag> MeshHandle;
+
+//objectIndexֻCPULOD͵±,ϴ
+struct DrawObject
+{
+	MeshHandle mesh;
+	uint32_t objectIndex;
+	ObjectData data;
+};
+
+//ģ̷߳Ⱦ̵߳һ֡״̬,ͨ彻
+struct FrameState
+{
+	uint64_t step = 0;
+	float time = 0.0f;
+	glm::mat4 view = glm::mat4(1.0f);
+	std::vector<DrawObject> drawObjects;
+};
+
+//GLFW̴ֻ߳¼,̲߳תģ߳
+struct InputEvent
+{
+	int key;
+	int action;
+	int mods;
+};
+
+//ֻ̬ڵǰ֡Ч,ֱӼ¼ʽеλ
+struct DynamicDrawObject
+{
+	Mesh mesh;
+	ObjectData data;
+};
+
+//беһ,ߺͼλͬڻƺϲһ
+struct DrawPacket
+{
+	VkPipeline pipeline;
+	VkBuffer vertexBuffer;
+	VkBuffer indexBuffer;
+	uint32_t indexCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	ObjectData data;
+};
+
+//һƹȫ״̬,Ӧһ
+struct DrawBatch
+{
+	VkPipeline pipeline;
+	VkBuffer vertexBuffer;
+	VkBuffer indexBuffer;
+	uint32_t firstCommand;
+	uint32_t commandCount;
+};
+
+//ÿŽͼƬһ,ڱӳ
+struct DrawBuffers
+{
+	BufferHandle objectBuffer;
+	BufferHandle indirectBuffer;
+	ObjectData* objects = nullptr;
+	VkDrawIndexedIndirectCommand* commands = nullptr;
 };
 
 class HelloTriangleApplication
@@ -153,10 +482,29 @@ class HelloTriangleApplication
 public:
 	void run()
 	{
+		Logger::instance().setMinSeverity(LogSeverity::Info);
+		Logger::instance().setRateLimit(LOG_RATE_LIMIT);
+		Logger::instance().start();
+		TRACE_THREAD_NAME("main");
+
 		initWindow();
 		initVulkan();
-		mainLoop();
+		startSimulation();
+		try
+		{
+			mainLoop();
+		}
+		catch (...)
+		{
+			//ģ̱߳쳣뿪run֮ǰ
+			stopSimulation();
+			throw;
+		}
+		stopSimulation();
 		cleanup();
+
+		TRACE_DUMP("trace.json");
+		Logger::instance().stop();
 	}
 private:
 	GLFWwindow* _window;
@@ -165,6 +513,9 @@ private:
 	VkDevice  _vkDevice;
 	VkQueue  _graphicsQueue;
 	VkQueue _presentQueue;
+	VkQueue _computeQueue;
+	uint32_t _graphicsQueueFamily;
+	uint32_t _computeQueueFamily;
 	VkSurfaceKHR _surface;
 	VkViewport _viewport;
 	VkRect2D _scissor;
@@ -174,27 +525,175 @@ private:
 	VkExtent2D _swapChainExtent;
 	std::vector<VkImageView> _swapChainImageViews;
 	VkRenderPass _renderPass;
+	VkSampleCountFlagBits _msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+	VkImage _colorImage;
+	VkDeviceMemory _colorImageMemory;
+	VkImageView _colorImageView;
+	//HDRɫ,زʱresolveĿ
+	VkImage _hdrImage;
+	VkDeviceMemory _hdrImageMemory;
+	VkImageView _hdrImageView;
+	//G-buffer: 0ǲɫ,1Ƿ,ֻȾʹ
+	std::array<VkImage, 2> _gbufferImages;
+	std::array<VkDeviceMemory, 2> _gbufferImageMemory;
+	std::array<VkImageView, 2> _gbufferImageViews;
+	VkFormat _depthFormat;
+	VkImage _depthImage;
+	VkDeviceMemory _depthImageMemory;
+	VkImageView _depthImageView;
+	ShaderInterface _shaderInterface;
+	DescriptorSetLayoutCache _descriptorSetLayoutCache;
+	PipelineLayoutCache _pipelineLayoutCache;
 	VkDescriptorSetLayout _descriptorSetLayout;
 	VkPipelineLayout _pipelineLayout;
-	VkPipeline _graphicPipeline;
-	std::vector<VkFramebuffer> _swapChainFramembuffers;
+	//ͨñ,ҲػǰĻ˹
+	PipelineHandle _graphicPipeline;
+	//Դѹ͹߱빲õĹ߳,Щʹ֮ǰ,
+	JobPool _jobPool;
+	PipelineManager<GraphicsPipelineState> _pipelineManager;
+	VkPipelineCache _pipelineCache = VK_NULL_HANDLE;
+	ShaderInterface _particleComputeInterface;
+	ShaderInterface _particleGraphicsInterface;
+	VkDescriptorSetLayout _particleDescriptorSetLayout;
+	VkPipelineLayout _particleComputePipelineLayout;
+	VkPipelineLayout _particleGraphicsPipelineLayout;
+	PipelineHandle _particleComputePipeline;
+	PipelineHandle _particleGraphicsPipeline;
+	//ģ״ֻ̬ڼ϶д;㻺ÿ֡һ,дתƸͼζл
+	BufferHandle _particleStateBuffer;
+	std::array<BufferHandle, MAX_FRAMES_IN_FLIGHT> _particleVertexBuffers;
+	VkDescriptorPool _particleDescriptorPool;
+	std::array<DescriptorSetHandle, MAX_FRAMES_IN_FLIGHT> _particleDescriptorSets;
+	bool _particleStateAcquired = false;
+	ParticleParams _particleParams = {};
+	ShaderInterface _lightingInterface;
+	VkDescriptorSetLayout _lightingDescriptorSetLayout;
+	VkPipelineLayout _lightingPipelineLayout;
+	PipelineHandle _lightingPipeline;
+	LightingParams _lightingParams = {};
+	BufferHandle _lightBuffer;
+	//G-buffer,潻ؽ
+	VkDescriptorPool _lightingDescriptorPool;
+	VkDescriptorSet _lightingDescriptorSet;
+	ShaderInterface _postInterface;
+	VkDescriptorSetLayout _postDescriptorSetLayout;
+	VkPipelineLayout _postPipelineLayout;
+	std::array<PipelineHandle, POST_PIPELINE_COUNT> _postPipelines;
+	PostParams _postParams = {};
+	//ֱʵķ,ɷģ
+	std::array<VkImage, 2> _bloomImages;
+	std::array<VkDeviceMemory, 2> _bloomImageMemory;
+	std::array<VkImageView, 2> _bloomImageViews;
+	//ͼƬΪ洢ͼƬʱ,ɫӳдblit
+	bool _swapChainStorageSupported = false;
+	VkImage _ldrImage = VK_NULL_HANDLE;
+	VkDeviceMemory _ldrImageMemory = VK_NULL_HANDLE;
+	VkImageView _ldrImageView = VK_NULL_HANDLE;
+	BufferHandle _luminanceBuffer;
+	//ع֡,֮֡Ŀ
+	BufferHandle _exposureBuffer;
+	//ÿ֡ع⸴ƵɶصĻ,֡ɺǷ
+	std::array<BufferHandle, MAX_FRAMES_IN_FLIGHT> _exposureReadbacks;
+	std::array<bool, MAX_FRAMES_IN_FLIGHT> _exposureReadbackPending = {};
+	bool _exposureAdapting = true;
+	VkDescriptorPool _postDescriptorPool;
+	std::array<VkDescriptorSet, POST_SET_COUNT> _postDescriptorSets;
+	//ɫӳǵǰͼƬ,ÿͼƬһ
+	std::vector<VkDescriptorSet> _tonemapDescriptorSets;
+	bool _postOverBudget = false;
+	VkFramebuffer _sceneFramebuffer;
 	VkCommandPool _commandPool;
 	std::vector<VkCommandBuffer> _commandBuffers;
+	VkCommandPool _computeCommandPool;
+	std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> _computeCommandBuffers = {};
+	FrameTimeline _computeTimeline;
 	std::vector<VkSemaphore> _imageAvailableSemaphores;
 	std::vector<VkSemaphore> _renderFinishedSemaphores;
-	std::vector<VkFence> _inFlightFences;
+	FrameTimeline _frameTimeline;
+	std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> _frameTimelineValues = {};
+	std::vector<uint64_t> _imagesInFlight;
 	size_t _currentFrame = 0;
 	bool _framebufferResized = false;
-	VkBuffer _vertexBuffer;
-	VkDeviceMemory _vertexBufferMemory;
-	VkBuffer _indexBuffer;
-	VkDeviceMemory _indexBufferMemory;
-	std::vector<VkBuffer> _uniformBuffers;
-	std::vector<VkDeviceMemory> _uniformBuffersMemory;
+	HandlePool<BufferTag, BufferResource> _bufferPool;
+	HandlePool<ImageTag, ImageResource> _imagePool;
+	HandlePool<PipelineTag, VkPipeline> _pipelinePool;
+	HandlePool<DescriptorSetTag, DescriptorSetResource> _descriptorSetPool;
+	DeferredDestructionQueue _destructionQueue;
+	//һ㻺һ
+	BufferHandle _vertexBuffer;
+	BufferHandle _indexBuffer;
+	RangeAllocator _vertexAllocator;
+	RangeAllocator _indexAllocator;
+	HandlePool<MeshTag, Mesh> _meshPool;
+	MeshHandle _quadMesh;
+	MeshHandle _triangleMesh;
+	MeshHandle _discMesh;
+	BufferHandle _dynamicGeometryBuffer;
+	StreamBuffer _dynamicGeometry;
+	std::vector<DynamicDrawObject> _dynamicDrawObjects;
+	//ÿ֡ؽ,ͬ//Ļ
+	DrawList<DrawPacket> _drawList;
+	RadixSorter _drawSorter;
+	std::vector<DrawBatch> _drawBatches;
+	std::vector<VkDrawIndexedIndirectCommand> _drawCommands;
+	std::vector<DrawBuffers> _drawBuffers;
+	//objectIndex¼һ֡ѡLOD
+	std::vector<uint8_t> _objectLods;
+	//֧ʱֱӻ,ɫȡݵķʽͬ
+	bool _multiDrawIndirectSupported = false;
+	uint32_t _maxDrawIndirectCount = 1;
+	std::vector<BufferHandle> _uniformBuffers;
 	VkDescriptorPool _descriptorPool;
-	std::vector<VkDescriptorSet> _descriptorSets;
-	VkImage _textureImage;
-	VkDeviceMemory  _textureImageMemory;
+	std::vector<DescriptorSetHandle> _descriptorSets;
+	//ҳͲʱһ̬,ֻһ
+	VkDescriptorSetLayout _materialDescriptorSetLayout;
+	VkDescriptorPool _materialDescriptorPool;
+	DescriptorSetHandle _materialDescriptorSet;
+	TripleBuffer<FrameState> _frameStates;
+	SpscQueue<InputEvent, 256> _inputEvents;
+	std::thread _simulationThread;
+	std::atomic<bool> _simulationRunning{ false };
+	//³Աֻģ߳з
+	uint64_t _simulationStep = 0;
+	double _simulationTime = 0.0;
+	bool _simulationPaused = false;
+	DamageTracker _damageTracker;
+	float _frameStateTime = 0.0f;
+	bool _refreshRequested = false;
+	bool _incrementalPresentSupported = false;
+	FrameStats _frameStats;
+	FrameStats::Clock::time_point _lastPresentTime;
+	FrameStats::Clock::time_point _lastFrameStatsDump;
+	//ÿ֡λʱ: ָ忪ʼͽ
+	VkQueryPool _timestampQueryPool = VK_NULL_HANDLE;
+	float _timestampPeriod = 0.0f;
+	uint64_t _timestampMask = 0;
+	std::array<bool, MAX_FRAMES_IN_FLIGHT> _frameStatsPending = {};
+	//֧display timingʱ,acquireֵõCPUʱ,GPUʱΪӳٹ
+	std::array<double, MAX_FRAMES_IN_FLIGHT> _estimatedLatency = {};
+	bool _displayTimingSupported = false;
+	PFN_vkGetPastPresentationTimingGOOGLE _getPastPresentationTiming = nullptr;
+	uint32_t _presentId = 0;
+	FrameStats::Clock::time_point _acquireTime;
+	std::array<FrameStats::Clock::time_point, PRESENT_HISTORY_SIZE> _presentAcquireTimes;
+	std::vector<VkPastPresentationTimingGOOGLE> _pastPresentationTimings;
+	AssetPack _assetPack;
+	std::vector<TextureRegion> _textureRegions;
+	std::vector<ImageHandle> _texturePages;
+	VkSampler _textureSampler = VK_NULL_HANDLE;
+	bool _texturePageIndexingSupported = false;
+	bool _textureCompressionBCSupported = false;
+	BufferHandle _materialBuffer;
+	std::unordered_map<uint64_t, uint32_t> _materialIndices;
+	//±,ѡػĹ߱
+	std::vector<uint32_t> _materialFlags;
+	uint32_t _quadMaterial = MATERIAL_UNTEXTURED;
+	BufferHandle _stagingBuffer;
+	StagingRing _stagingRing;
+	FrameTimeline _transferTimeline;
+	VkCommandBuffer _uploadCommandBuffer = VK_NULL_HANDLE;
+	std::deque<std::pair<uint64_t, VkCommandBuffer>> _pendingUploadCommandBuffers;
+	std::vector<VkCommandBuffer> _freeUploadCommandBuffers;
 
 
 	void initWindow()
@@ -205,6 +704,128 @@ private:
 		_window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
 		glfwSetWindowUserPointer(_window,this);
 		glfwSetFramebufferSizeCallback(_window, framebufferResizeCallback);
+		glfwSetKeyCallback(_window, keyCallback);
+		glfwSetWindowRefreshCallback(_window, windowRefreshCallback);
+	}
+
+	//ڱڵָ,ûб仯,ֻҪ³
+	static void windowRefreshCallback(GLFWwindow* window)
+	{
+		auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+		app->_refreshRequested = true;
+	}
+
+	static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+	{
+		auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+		//ʱ,¼
+		app->_inputEvents.push({ key, action, mods });
+		app->_damageTracker.invalidate();
+	}
+
+	void startSimulation()
+	{
+		//ͬһγʼ״̬,Ⱦ̵߳ĵһ֡
+		stepSimulation(0.0);
+		publishFrameState();
+
+		_simulationRunning.store(true, std::memory_order_release);
+		_simulationThread = std::thread(&HelloTriangleApplication::simulationLoop, this);
+	}
+
+	void stopSimulation()
+	{
+		_simulationRunning.store(false, std::memory_order_release);
+		if (_simulationThread.joinable())
+			_simulationThread.join();
+	}
+
+	//̶ƽģ,Ⱦ
+	void simulationLoop()
+	{
+		using Clock = std::chrono::steady_clock;
+		const auto timestep = std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(SIMULATION_TIMESTEP));
+
+		TRACE_THREAD_NAME("simulation");
+
+		auto nextStep = Clock::now() + timestep;
+		while (_simulationRunning.load(std::memory_order_acquire))
+		{
+			InputEvent event;
+			while (_inputEvents.pop(event))
+			{
+				handleInput(event);
+			}
+
+			stepSimulation(SIMULATION_TIMESTEP);
+			nextStep += timestep;
+
+			auto now = Clock::now();
+			if (now - nextStep > timestep * MAX_SIMULATION_STEPS)
+			{
+				nextStep = now;
+			}
+
+			//׷ʱӺŷ,ʱƽಽ
+			if (nextStep > now)
+			{
+				publishFrameState();
+				std::this_thread::sleep_until(nextStep);
+			}
+		}
+	}
+
+	void handleInput(const InputEvent& event)
+	{
+		if (event.key == GLFW_KEY_SPACE && event.action == GLFW_PRESS)
+		{
+			_simulationPaused = !_simulationPaused;
+		}
+	}
+
+	void stepSimulation(double deltaTime)
+	{
+		TRACE_FUNCTION();
+		if (!_simulationPaused)
+		{
+			_simulationTime += deltaTime;
+		}
+		++_simulationStep;
+	}
+
+	//ģдд,еvectorᱻ,ȶٷ
+	void publishFrameState()
+	{
+		TRACE_FUNCTION();
+		float time = static_cast<float>(_simulationTime);
+
+		FrameState& state = _frameStates.writeBuffer();
+		state.step = _simulationStep;
+		state.time = time;
+		state.view = glm::lookAt(glm::vec3(2.0f,2.0f,2.0f),
+			glm::vec3(0.0f,0.0f,0.0f),glm::vec3(0.0f,0.0f,1.0f));
+
+		state.drawObjects.resize(3);
+		state.drawObjects[0].mesh = _quadMesh;
+		state.drawObjects[0].data.model = glm::rotate(glm::mat4(1.0f),time*glm::radians(90.0f),
+			glm::vec3(0.0f,0.0f,1.0f));
+		state.drawObjects[0].objectIndex = 0;
+		state.drawObjects[0].data.materialIndex = _quadMaterial;
+		state.drawObjects[1].mesh = _triangleMesh;
+		state.drawObjects[1].data.model = glm::rotate(
+			glm::translate(glm::mat4(1.0f), glm::vec3(0.0f,0.0f,0.5f)),
+			-time*glm::radians(90.0f), glm::vec3(0.0f,0.0f,1.0f));
+		state.drawObjects[1].objectIndex = 1;
+		state.drawObjects[1].data.materialIndex = MATERIAL_UNTEXTURED;
+		//決߷Զ,仯ʱлLOD
+		state.drawObjects[2].mesh = _discMesh;
+		state.drawObjects[2].data.model = glm::translate(glm::mat4(1.0f),
+			glm::vec3(0.0f,0.0f,-1.0f) - glm::vec3(1.0f,1.0f,0.0f)*(1.75f+1.75f*std::sin(time*0.5f)));
+		state.drawObjects[2].objectIndex = 2;
+		state.drawObjects[2].data.materialIndex = _quadMaterial;
+
+		_frameStates.publish();
 	}
 
 	static void framebufferResizeCallback(GLFWwindow* window, int widht, int height)
@@ -215,6 +836,9 @@ private:
 
 	void initVulkan()
 	{
+		TRACE_FUNCTION();
+		createJobPool();
+		loadAssetPack();
 		createInstance();
 		setupDebugCallback();
 		createSurface();
@@ -224,25 +848,103 @@ private:
 		createImageViews();
 		createRenderPass();
 		createDescriptorSetLayout();
+		createParticleLayouts();
+		createPostLayouts();
+		createLightingLayouts();
+		createPipelineManager();
 		createGraphicsPipeline();
-		createFramebuffers();
+		createParticleGraphicsPipeline();
+		createLightingPipeline();
+		createParticleComputePipeline();
+		createPostPipelines();
+		createColorResources();
+		createDepthResources();
+		createGBufferResources();
+		createHdrResources();
+		createSceneFramebuffer();
 		createCommandPool();
-		createTextureImage();
+		createComputeCommandBuffers();
+		createTimestampQueryPool();
+		createStagingRing();
+		createTexturePages();
+		createTextureSampler();
+		createMaterials();
 		createVertexBuffer();
 		createIndexBuffer();
+		createMeshes();
+		createDynamicGeometryBuffer();
+		createParticleBuffer();
+		createDrawSorter();
 		createUniformBuffers();
+		createDrawBuffers();
 		createDescriptorPool();
 		createDescriptorSets();
+		createParticleDescriptorSets();
+		createMaterialDescriptorSet();
+		createExposureBuffer();
+		createLightBuffer();
+		createPostDescriptorSets();
+		createLightingDescriptorSet();
 		createCommandBuffers();
 		createSyncObjects();
 	}
 
+	void createJobPool()
+	{
+		//һ߳,parallelForʱҲȡ;ʱҲһ,߱Ҫ̨߳
+		uint32_t workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+		_jobPool.start(workerCount);
+	}
+
+	void loadAssetPack()
+	{
+		TRACE_FUNCTION();
+		if (!_assetPack.open(ASSET_PACK_PATH, &_jobPool))
+		{
+			throw std::runtime_error("failed to open asset pack!");
+		}
+	}
+
+	void createDrawSorter()
+	{
+		_drawSorter.setJobPool(&_jobPool);
+	}
+
+	//ӳͼ,;asset_cookѹɫ,ֻδѹԴ
+	std::span<const uint8_t> readAsset(const char* name)
+	{
+		const PackEntry* entry = _assetPack.find(name);
+		if (entry == nullptr)
+		{
+			throw std::runtime_error(std::string("failed to find asset ") + name + "!");
+		}
+
+		std::span<const uint8_t> data = _assetPack.view(*entry);
+		if (data.empty())
+		{
+			throw std::runtime_error(std::string("failed to map compressed asset ") + name + "!");
+		}
+		return data;
+	}
+
 	void mainLoop()
 	{
 		while (!glfwWindowShouldClose(_window))
 		{
-			glfwPollEvents();
+			//ûб仯ʱ,ʱģ߳Ƿ񷢲״̬
+			if (enableOnDemandRendering && !_damageTracker.hasDamage()
+				&& !_refreshRequested && !_framebufferResized && !_exposureAdapting)
+			{
+				glfwWaitEventsTimeout(ON_DEMAND_WAIT_TIMEOUT);
+			}
+			else
+			{
+				glfwPollEvents();
+			}
+
+			pollFrameState();
 			drawFrame();
+			updateFrameStats();
 		}
 
 		vkDeviceWaitIdle(_vkDevice);
@@ -250,35 +952,93 @@ private:
 
 	void cleanup()
 	{
+		TRACE_FUNCTION();
 		cleanupSwapChain();
+		_drawSorter.setJobPool(nullptr);
+		_pipelineManager.stop();
+		_jobPool.stop();
+		vkDestroyPipelineCache(_vkDevice, _pipelineCache, nullptr);
+
+		releaseDescriptorSet(_materialDescriptorSet);
+		releaseBuffer(_materialBuffer);
+		for (auto page : _texturePages)
+		{
+			releaseImage(page);
+		}
+		vkDestroySampler(_vkDevice, _textureSampler, nullptr);
 
-		vkDestroyImage(_vkDevice, _textureImage, nullptr);
-		vkFreeMemory(_vkDevice,_textureImageMemory,nullptr);
+		for (auto descriptorSet : _descriptorSets)
+		{
+			releaseDescriptorSet(descriptorSet);
+		}
 
-		vkDestroyDescriptorPool(_vkDevice, _descriptorPool, nullptr);
+		for (auto uniformBuffer : _uniformBuffers)
+		{
+			releaseBuffer(uniformBuffer);
+		}
 
-		vkDestroyDescriptorSetLayout(_vkDevice, _descriptorSetLayout, nullptr);
+		for (const auto& buffers : _drawBuffers)
+		{
+			vkUnmapMemory(_vkDevice, _bufferPool[buffers.objectBuffer].memory);
+			vkUnmapMemory(_vkDevice, _bufferPool[buffers.indirectBuffer].memory);
+			releaseBuffer(buffers.objectBuffer);
+			releaseBuffer(buffers.indirectBuffer);
+		}
 
-		for (size_t i = 0; i < _swapChainImages.size(); ++i)
+		releasePipeline(_particleComputePipeline);
+		for (auto pipeline : _postPipelines)
+		{
+			releasePipeline(pipeline);
+		}
+		releaseBuffer(_exposureBuffer);
+		for (auto readback : _exposureReadbacks)
+		{
+			releaseBuffer(readback);
+		}
+		if (DEFERRED_SHADING)
+		{
+			releaseBuffer(_lightBuffer);
+		}
+		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
 		{
-			vkDestroyBuffer(_vkDevice,_uniformBuffers[i],nullptr);
-			vkFreeMemory(_vkDevice, _uniformBuffersMemory[i], nullptr);
+			releaseDescriptorSet(_particleDescriptorSets[i]);
+			releaseBuffer(_particleVertexBuffers[i]);
 		}
+		releaseBuffer(_particleStateBuffer);
+
+		vkUnmapMemory(_vkDevice, _bufferPool[_dynamicGeometryBuffer].memory);
+		releaseBuffer(_dynamicGeometryBuffer);
+		releaseMesh(_discMesh);
+		releaseMesh(_triangleMesh);
+		releaseMesh(_quadMesh);
+		releaseBuffer(_indexBuffer);
+		releaseBuffer(_vertexBuffer);
+
+		vkUnmapMemory(_vkDevice, _bufferPool[_stagingBuffer].memory);
+		releaseBuffer(_stagingBuffer);
+		_transferTimeline.destroy();
 
-		vkDestroyBuffer(_vkDevice, _indexBuffer, nullptr);
-		vkFreeMemory(_vkDevice, _indexBufferMemory, nullptr);
+		//豸ѿ,ӳͷŵԴ
+		_destructionQueue.flush();
 
-		vkDestroyBuffer(_vkDevice,_vertexBuffer,nullptr);
-		vkFreeMemory(_vkDevice,_vertexBufferMemory,nullptr);
+		vkDestroyDescriptorPool(_vkDevice, _descriptorPool, nullptr);
+		vkDestroyDescriptorPool(_vkDevice, _particleDescriptorPool, nullptr);
+		vkDestroyDescriptorPool(_vkDevice, _materialDescriptorPool, nullptr);
+
+		_pipelineLayoutCache.destroy();
+		_descriptorSetLayoutCache.destroy();
 
 		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
 		{
 			vkDestroySemaphore(_vkDevice, _renderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(_vkDevice, _imageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(_vkDevice, _inFlightFences[i], nullptr);
 		}
+		_frameTimeline.destroy();
+		_computeTimeline.destroy();
 
 		vkDestroyCommandPool(_vkDevice, _commandPool, nullptr);
+		vkDestroyCommandPool(_vkDevice, _computeCommandPool, nullptr);
+		vkDestroyQueryPool(_vkDevice, _timestampQueryPool, nullptr);
 		
 		vkDestroyDevice(_vkDevice, nullptr);
 		if (enableValidationLayers)
@@ -322,6 +1082,7 @@ private:
 
 	void createInstance()
 	{
+		TRACE_FUNCTION();
 		if (enableValidationLayers && !checkValidationLayerSupport())
 		{
 			throw std::runtime_error("validation layers requested,but not available!");
@@ -390,6 +1151,7 @@ private:
 
 	void setupDebugCallback()
 	{
+		TRACE_FUNCTION();
 		if (!enableValidationLayers) 
 			return;
 		VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
@@ -444,6 +1206,7 @@ private:
 
 	void selectPhysicalDevice()
 	{
+		TRACE_FUNCTION();
 		_physicalDevice = VK_NULL_HANDLE;
 		uint32_t deviceCount = 0;
 		vkEnumeratePhysicalDevices(_vkInstance, &deviceCount, nullptr);
@@ -465,6 +1228,58 @@ private:
 		{
 			throw std::runtime_error("failed to find a suitable GPU");
 		}
+
+		_msaaSamples = DEFERRED_SHADING ? VK_SAMPLE_COUNT_1_BIT : getMaxUsableSampleCount(MSAA_SAMPLES);
+		_depthFormat = findDepthFormat();
+	}
+
+	VkSampleCountFlagBits getMaxUsableSampleCount(VkSampleCountFlagBits requested)
+	{
+		VkPhysicalDeviceProperties physicalDeviceProperties;
+		vkGetPhysicalDeviceProperties(_physicalDevice, &physicalDeviceProperties);
+
+		VkSampleCountFlags counts = physicalDeviceProperties.limits.framebufferColorSampleCounts
+			& physicalDeviceProperties.limits.framebufferDepthSampleCounts;
+
+		//ֵʼҵһ豸ֵ֧Ĳ
+		for (uint32_t samples = requested; samples > VK_SAMPLE_COUNT_1_BIT; samples >>= 1)
+		{
+			if (counts & samples)
+				return static_cast<VkSampleCountFlagBits>(samples);
+		}
+
+		return VK_SAMPLE_COUNT_1_BIT;
+	}
+
+	VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates,
+		VkImageTiling tiling, VkFormatFeatureFlags features)
+	{
+		for (VkFormat format : candidates)
+		{
+			VkFormatProperties props;
+			vkGetPhysicalDeviceFormatProperties(_physicalDevice, format, &props);
+
+			if (tiling == VK_IMAGE_TILING_LINEAR &&
+				(props.linearTilingFeatures & features) == features)
+			{
+				return format;
+			}
+			else if (tiling == VK_IMAGE_TILING_OPTIMAL &&
+				(props.optimalTilingFeatures & features) == features)
+			{
+				return format;
+			}
+		}
+
+		throw std::runtime_error("failed to find supported format!");
+	}
+
+	VkFormat findDepthFormat()
+	{
+		return findSupportedFormat(
+			{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 	}
 
 	bool isDeviceSuitable(VkPhysicalDevice device)
@@ -488,10 +1303,35 @@ private:
 				&& !swapChainSupport.presentModes.empty();
 		}
 
+		bool timelineSupported = false;
+		if (extensionSupported)
+		{
+			VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+			timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+			VkPhysicalDeviceFeatures2 deviceFeatures2 = {};
+			deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			deviceFeatures2.pNext = &timelineFeatures;
+			vkGetPhysicalDeviceFeatures2(device, &deviceFeatures2);
+
+			timelineSupported = timelineFeatures.timelineSemaphore == VK_TRUE;
+		}
+
+		//ͳ,ɫӳд벻ʽĴ洢ͼƬ
+		VkPhysicalDeviceSubgroupProperties subgroupProperties = {};
+		subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+		VkPhysicalDeviceProperties2 deviceProperties2 = {};
+		deviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		deviceProperties2.pNext = &subgroupProperties;
+		vkGetPhysicalDeviceProperties2(device, &deviceProperties2);
+		bool postProcessingSupported = (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT)
+			&& (subgroupProperties.supportedOperations & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT)
+			&& deviceFeatures.shaderStorageImageWriteWithoutFormat;
+
 		return deviceProperties.deviceType==VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU
 			&&deviceFeatures.geometryShader&&
 			indices.isComplete()&&extensionSupported
-			&&swapChainAdequate;
+			&&swapChainAdequate&&timelineSupported&&postProcessingSupported;
 	}
 
 	QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device)
@@ -507,8 +1347,10 @@ private:
 		{
 			VkQueueFamilyProperties queueFamily = queueFamilies[i];
 
+			//ģͼζdispatch,ͼζҲּ֧
 			if (queueFamily.queueCount > 0
-				&& queueFamily.queueFlags&VK_QUEUE_GRAPHICS_BIT)
+				&& queueFamily.queueFlags&VK_QUEUE_GRAPHICS_BIT
+				&& queueFamily.queueFlags&VK_QUEUE_COMPUTE_BIT)
 			{
 				indices.graphicsFamily = i;
 			}
@@ -524,18 +1366,32 @@ private:
 			if (indices.isComplete())
 				break;
 		}
+
+		//ļͼζвִ
+		indices.computeFamily = indices.graphicsFamily;
+		for (uint32_t i = 0; i < queueFamilyCount; ++i)
+		{
+			if (queueFamilies[i].queueCount > 0
+				&& queueFamilies[i].queueFlags&VK_QUEUE_COMPUTE_BIT
+				&& !(queueFamilies[i].queueFlags&VK_QUEUE_GRAPHICS_BIT))
+			{
+				indices.computeFamily = i;
+				break;
+			}
+		}
 		return indices;
 	}
 	
 	void createLogicalDevice()
 	{
+		TRACE_FUNCTION();
 		if (_physicalDevice == VK_NULL_HANDLE)
 			return;
 
 		QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		std::set<int> uniqueQueueFamilies = {indices.graphicsFamily,
-			indices.presentFamily};
+			indices.presentFamily, indices.computeFamily};
 
 		float queuePriority = 1.0f;
 		for (int queueFamily : uniqueQueueFamilies)
@@ -548,15 +1404,48 @@ private:
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		//ԴеĲ͸BC1ѹ
+		//ƬԪɫеҳ±,±һλͳһ
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(_physicalDevice, &supportedFeatures);
 		VkPhysicalDeviceFeatures deviceFeatures = {};
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+		_textureCompressionBCSupported = supportedFeatures.textureCompressionBC == VK_TRUE;
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+		_texturePageIndexingSupported = supportedFeatures.shaderSampledImageArrayDynamicIndexing == VK_TRUE;
+		//һһvkCmdDrawIndexedIndirect,ÿfirstInstanceһ±
+		deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+		deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+		_multiDrawIndirectSupported = supportedFeatures.multiDrawIndirect == VK_TRUE
+			&& supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(_physicalDevice, &deviceProperties);
+		_maxDrawIndirectCount = std::max(1u, deviceProperties.limits.maxDrawIndirectCount);
+		deviceFeatures.shaderStorageImageWriteWithoutFormat = VK_TRUE;
+
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+		timelineFeatures.timelineSemaphore = VK_TRUE;
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = &timelineFeatures;
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtension.size());
-		createInfo.ppEnabledExtensionNames = deviceExtension.data();
+		std::vector<const char*> enabledExtensions = deviceExtension;
+		for (const char* extension : optionalDeviceExtension)
+		{
+			if (isDeviceExtensionAvailable(_physicalDevice, extension))
+				enabledExtensions.push_back(extension);
+		}
+		_incrementalPresentSupported = isDeviceExtensionAvailable(_physicalDevice,
+			VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+		_displayTimingSupported = isDeviceExtensionAvailable(_physicalDevice,
+			VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 		if (enableValidationLayers)
 		{
 			createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -574,10 +1463,25 @@ private:
 
 		vkGetDeviceQueue(_vkDevice, indices.graphicsFamily, 0, &_graphicsQueue);
 		vkGetDeviceQueue(_vkDevice,indices.presentFamily,0,&_presentQueue);
+		vkGetDeviceQueue(_vkDevice, indices.computeFamily, 0, &_computeQueue);
+		_graphicsQueueFamily = static_cast<uint32_t>(indices.graphicsFamily);
+		_computeQueueFamily = static_cast<uint32_t>(indices.computeFamily);
+
+		//չҪͨ豸ȡ
+		if (_displayTimingSupported)
+		{
+			_getPastPresentationTiming = (PFN_vkGetPastPresentationTimingGOOGLE)
+				vkGetDeviceProcAddr(_vkDevice, "vkGetPastPresentationTimingGOOGLE");
+			_displayTimingSupported = _getPastPresentationTiming != nullptr;
+		}
+
+		_descriptorSetLayoutCache.init(_vkDevice);
+		_pipelineLayoutCache.init(_vkDevice);
 	}
 
 	void createSurface()
 	{
+		TRACE_FUNCTION();
 		VkResult res= glfwCreateWindowSurface(_vkInstance, _window, nullptr, &_surface);
 		if (res != VK_SUCCESS)
 		{
@@ -585,6 +1489,21 @@ private:
 		}
 	}
 
+	bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char* name)
+	{
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const auto& extension : availableExtensions)
+		{
+			if (strcmp(extension.extensionName, name) == 0)
+				return true;
+		}
+		return false;
+	}
 	bool checkDeviceExtensionSupport(VkPhysicalDevice device)
 	{
 		uint32_t extensionCount;
@@ -687,6 +1606,7 @@ private:
 
 	void createSwapChain()
 	{
+		TRACE_FUNCTION();
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(_physicalDevice);
 
 		VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -708,7 +1628,13 @@ private:
 		createInfo.imageColorSpace = surfaceFormat.colorSpace;
 		createInfo.imageExtent = extent;
 		createInfo.imageArrayLayers = 1;
-		createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		//ɫӳֱд뽻ͼƬ,ִ֧洢ʱLDRͼƬblit
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(_physicalDevice, surfaceFormat.format, &formatProperties);
+		_swapChainStorageSupported = (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT)
+			&& (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+		createInfo.imageUsage = _swapChainStorageSupported ? VK_IMAGE_USAGE_STORAGE_BIT
+			: VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
 		QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
 		uint32_t queueFamilyIndices[] = {(uint32_t)indices.graphicsFamily,(uint32_t)indices.presentFamily};
@@ -739,46 +1665,219 @@ private:
 		vkGetSwapchainImagesKHR(_vkDevice, _swapChain, &imageCount, nullptr);
 		_swapChainImages.resize(imageCount);
 		vkGetSwapchainImagesKHR(_vkDevice, _swapChain, &imageCount, _swapChainImages.data());
-		
+		_imagesInFlight.assign(imageCount, 0);
+		_damageTracker.reset(imageCount, extent);
+
 		_swapChainImageFormat = surfaceFormat.format;
 		_swapChainExtent = extent;
 	}
 
 	void createImageViews()
 	{
+		TRACE_FUNCTION();
 		_swapChainImageViews.resize(_swapChainImages.size());
 		for (size_t i = 0; i < _swapChainImages.size(); ++i)
 		{
-			VkImageViewCreateInfo createInfo = {};
-			createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-			createInfo.image = _swapChainImages[i];
-			createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-			createInfo.format = _swapChainImageFormat;
-			createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-			createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-			createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-			createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-			createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			createInfo.subresourceRange.baseMipLevel = 0;
-			createInfo.subresourceRange.levelCount = 1;
-			createInfo.subresourceRange.baseArrayLayer = 0;
-			createInfo.subresourceRange.layerCount = 1;
-
-			if (vkCreateImageView(_vkDevice, &createInfo, nullptr,
-				&_swapChainImageViews[i]) != VK_SUCCESS)
-			{
-				throw std::runtime_error("failed to create image views!");
-			}
+			_swapChainImageViews[i] = createImageView(_swapChainImages[i],
+				_swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
 		}
 	}
 
-	void createGraphicsPipeline()
+	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags,
+		VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, uint32_t mipLevels = 1, uint32_t layerCount = 1)
 	{
-		/*ɱ̽׶*/
-		auto vertShaderCode = readFile("shaders/vert.spv");
-		auto fragShaderCode = readFile("shaders/frag.spv");
+		VkImageViewCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		createInfo.image = image;
+		createInfo.viewType = viewType;
+		createInfo.format = format;
+		createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+		createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+		createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+		createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+		createInfo.subresourceRange.aspectMask = aspectFlags;
+		createInfo.subresourceRange.baseMipLevel = 0;
+		createInfo.subresourceRange.levelCount = mipLevels;
+		createInfo.subresourceRange.baseArrayLayer = 0;
+		createInfo.subresourceRange.layerCount = layerCount;
+
+		VkImageView imageView;
+		if (vkCreateImageView(_vkDevice, &createInfo, nullptr,
+			&imageView) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create image views!");
+		}
 
-		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
+		return imageView;
+	}
+
+	//زɫֻsubpassʹ,tile GPUϲҪʵԴ
+	void createColorResources()
+	{
+		TRACE_FUNCTION();
+		if (_msaaSamples == VK_SAMPLE_COUNT_1_BIT)
+			return;
+
+		createImage(_swapChainExtent.width, _swapChainExtent.height, 1, 1, _msaaSamples,
+			HDR_FORMAT, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+			_colorImage, _colorImageMemory);
+
+		_colorImageView = createImageView(_colorImage, HDR_FORMAT,
+			VK_IMAGE_ASPECT_COLOR_BIT);
+	}
+
+	//мͼƬȲֺͻ,ߴ潻
+	void createHdrResources()
+	{
+		TRACE_FUNCTION();
+		createImage(_swapChainExtent.width, _swapChainExtent.height, 1, 1, VK_SAMPLE_COUNT_1_BIT,
+			HDR_FORMAT, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _hdrImage, _hdrImageMemory);
+		_hdrImageView = createImageView(_hdrImage, HDR_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+		VkExtent2D halfExtent = bloomExtent();
+		for (size_t i = 0; i < _bloomImages.size(); ++i)
+		{
+			createImage(halfExtent.width, halfExtent.height, 1, 1, VK_SAMPLE_COUNT_1_BIT,
+				HDR_FORMAT, VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _bloomImages[i], _bloomImageMemory[i]);
+			_bloomImageViews[i] = createImageView(_bloomImages[i], HDR_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT);
+		}
+
+		//UNORMɫӳsRGB;_SRGBblit,LDRͼƬֵ,øɫ
+		bool srgbSwapChain = isSrgbFormat(_swapChainImageFormat);
+		_postParams.encodeSrgb = srgbSwapChain ? 0 : 1;
+		if (!_swapChainStorageSupported)
+		{
+			VkFormat ldrFormat = srgbSwapChain ? HDR_FORMAT : VK_FORMAT_R8G8B8A8_UNORM;
+			createImage(_swapChainExtent.width, _swapChainExtent.height, 1, 1, VK_SAMPLE_COUNT_1_BIT,
+				ldrFormat, VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _ldrImage, _ldrImageMemory);
+			_ldrImageView = createImageView(_ldrImage, ldrFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+		}
+
+		//ͳƵÿдһֺ
+		_postParams.partialCount = postGroupCount(halfExtent.width) * postGroupCount(halfExtent.height);
+		_postParams.pixelCount = halfExtent.width * halfExtent.height;
+		_luminanceBuffer = createBufferResource(sizeof(float) * _postParams.partialCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+
+	static bool isSrgbFormat(VkFormat format)
+	{
+		return format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_R8G8B8A8_SRGB
+			|| format == VK_FORMAT_A8B8G8R8_SRGB_PACK32;
+	}
+
+	VkExtent2D bloomExtent() const
+	{
+		return { std::max(1u, _swapChainExtent.width / 2), std::max(1u, _swapChainExtent.height / 2) };
+	}
+
+	static uint32_t postGroupCount(uint32_t size)
+	{
+		return (size + POST_WORKGROUP_SIZE - 1) / POST_WORKGROUP_SIZE;
+	}
+
+	void createDepthResources()
+	{
+		TRACE_FUNCTION();
+		//ӳɫĹsubpassؽλ
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		if (DEFERRED_SHADING)
+			usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+		createImage(_swapChainExtent.width, _swapChainExtent.height, 1, 1, _msaaSamples,
+			_depthFormat, VK_IMAGE_TILING_OPTIMAL, usage,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+			_depthImage, _depthImageMemory);
+
+		_depthImageView = createImageView(_depthImage, _depthFormat,
+			VK_IMAGE_ASPECT_DEPTH_BIT);
+	}
+
+	//G-bufferֻȾдͶȡ,زɫһҪʵԴ
+	void createGBufferResources()
+	{
+		TRACE_FUNCTION();
+		if (!DEFERRED_SHADING)
+			return;
+
+		std::array<VkFormat, 2> formats = { GBUFFER_ALBEDO_FORMAT, GBUFFER_NORMAL_FORMAT };
+		for (size_t i = 0; i < _gbufferImages.size(); ++i)
+		{
+			createImage(_swapChainExtent.width, _swapChainExtent.height, 1, 1, VK_SAMPLE_COUNT_1_BIT,
+				formats[i], VK_IMAGE_TILING_OPTIMAL,
+				VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+				| VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+				_gbufferImages[i], _gbufferImageMemory[i]);
+			_gbufferImageViews[i] = createImageView(_gbufferImages[i], formats[i], VK_IMAGE_ASPECT_COLOR_BIT);
+		}
+	}
+
+	//ڹ߳ϱ,һ߻,֮ͬɫ׶οԸ
+	void createPipelineManager()
+	{
+		TRACE_FUNCTION();
+		VkPipelineCacheCreateInfo cacheInfo = {};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		if (vkCreatePipelineCache(_vkDevice, &cacheInfo, nullptr, &_pipelineCache) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+
+		//ռһ̱߳,ÿ֡
+		uint32_t maxCompileJobs = std::max(1u, std::thread::hardware_concurrency() / 2);
+		_pipelineManager.start(_jobPool, maxCompileJobs, [this](const GraphicsPipelineState& state)
+		{
+			return buildGraphicsPipeline(state);
+		});
+	}
+
+	void createGraphicsPipeline()
+	{
+		TRACE_FUNCTION();
+		//ӿڲü
+		_viewport = {};
+		_viewport.x = 0.0f;
+		_viewport.y = 0.0f;
+		_viewport.width = (float)_swapChainExtent.width;
+		_viewport.height = (float)_swapChainExtent.height;
+		_viewport.minDepth = 0.0f;
+		_viewport.maxDepth = 1.0f;
+
+		_scissor = {};
+		_scissor.offset = {0,0};
+		_scissor.extent = _swapChainExtent;
+
+		//߲,ɷӻȡ,ؽʱظ
+		_pipelineLayout = _pipelineLayoutCache.get(_descriptorSetLayoutCache, _shaderInterface);
+
+		//ͨñͬ,ػǰ
+		GraphicsPipelineState state = {};
+		VkPipeline graphicPipeline = buildGraphicsPipeline(state);
+		if (graphicPipeline == VK_NULL_HANDLE)
+		{
+			throw std::runtime_error("failed to create graphics pipeline!");
+		}
+		_graphicPipeline = _pipelinePool.allocate(graphicPipeline);
+		_pipelineManager.setFallback(graphicPipeline);
+	}
+
+	//Ҳڹ߱߳ϵ,ֻȡؽʱŻıĳԱ,ؽǰPipelineManager::resetȱ
+	VkPipeline buildGraphicsPipeline(const GraphicsPipelineState& state)
+	{
+		TRACE_FUNCTION();
+		/*ɱ̽׶*/
+		auto vertShaderCode = readAsset("shaders/vertex.vert");
+		auto fragShaderCode = readAsset("shaders/pixel.frag");
+
+		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
 		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
 		VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
 		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -790,6 +1889,26 @@ private:
 		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 		fragShaderStageInfo.module = fragShaderModule;
 		fragShaderStageInfo.pName = "main";
+		//ʷ֧ǷдG-bufferػڱʱȷ
+		struct FragmentSpecialization
+		{
+			uint32_t materialVariant;
+			VkBool32 writeNormal;
+		};
+		FragmentSpecialization specialization = { state.materialVariant, DEFERRED_SHADING ? VK_TRUE : VK_FALSE };
+		std::array<VkSpecializationMapEntry, 2> specializationEntries = {};
+		specializationEntries[0].constantID = 0;
+		specializationEntries[0].offset = offsetof(FragmentSpecialization, materialVariant);
+		specializationEntries[0].size = sizeof(uint32_t);
+		specializationEntries[1].constantID = 1;
+		specializationEntries[1].offset = offsetof(FragmentSpecialization, writeNormal);
+		specializationEntries[1].size = sizeof(VkBool32);
+		VkSpecializationInfo specializationInfo = {};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+		specializationInfo.pMapEntries = specializationEntries.data();
+		specializationInfo.dataSize = sizeof(FragmentSpecialization);
+		specializationInfo.pData = &specialization;
+		fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
 		VkPipelineShaderStageCreateInfo shaderStages[] = {
 			vertShaderStageInfo,
 			fragShaderStageInfo
@@ -801,6 +1920,16 @@ private:
 		auto bindingDescription = Vertex::getBindingDescription();
 		auto attributeDescription = Vertex::getAttributeDescriptions();
 
+		for (const auto& input : _shaderInterface.vertexInputs)
+		{
+			auto it = std::find_if(attributeDescription.begin(), attributeDescription.end(),
+				[&](const VkVertexInputAttributeDescription& a) { return a.location == input.location; });
+			if (it == attributeDescription.end())
+			{
+				throw std::runtime_error("vertex shader input not provided by vertex layout!");
+			}
+		}
+
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 		vertexInputInfo.vertexBindingDescriptionCount = 1;
@@ -813,18 +1942,6 @@ private:
 		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 		inputAssembly.primitiveRestartEnable = VK_FALSE;
 		//ӿڲü
-		_viewport = {};
-		_viewport.x = 0.0f;
-		_viewport.y = 0.0f;
-		_viewport.width = (float)_swapChainExtent.width;
-		_viewport.height = (float)_swapChainExtent.height;
-		_viewport.minDepth = 0.0f;
-		_viewport.maxDepth = 1.0f;
-
-		_scissor = {};
-		_scissor.offset = {0,0};
-		_scissor.extent = _swapChainExtent;
-
 		VkPipelineViewportStateCreateInfo viewportState = {};
 		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 		viewportState.viewportCount = 1;
@@ -850,7 +1967,7 @@ private:
 		VkPipelineMultisampleStateCreateInfo multisampleStage = {};
 		multisampleStage.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 		multisampleStage.sampleShadingEnable = VK_FALSE;
-		multisampleStage.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisampleStage.rasterizationSamples = _msaaSamples;
 		multisampleStage.minSampleShading = 1.0f;
 		multisampleStage.pSampleMask = nullptr;
 		multisampleStage.alphaToCoverageEnable = VK_FALSE;
@@ -858,6 +1975,12 @@ private:
 
 		//Ⱥģ
 		VkPipelineDepthStencilStateCreateInfo depthStencilStage = {};
+		depthStencilStage.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencilStage.depthTestEnable = VK_TRUE;
+		depthStencilStage.depthWriteEnable = VK_TRUE;
+		depthStencilStage.depthCompareOp = VK_COMPARE_OP_LESS;
+		depthStencilStage.depthBoundsTestEnable = VK_FALSE;
+		depthStencilStage.stencilTestEnable = VK_FALSE;
 
 		//ɫ
 		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
@@ -870,12 +1993,15 @@ private:
 		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
 		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
 		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+		//ӳɫʱͬʱдɫͷG-buffer
+		std::array<VkPipelineColorBlendAttachmentState, 2> colorBlendAttachments = {
+			colorBlendAttachment, colorBlendAttachment };
 
 		VkPipelineColorBlendStateCreateInfo colorBlendStage = {};
 		colorBlendStage.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 		colorBlendStage.logicOpEnable = VK_FALSE;
-		colorBlendStage.attachmentCount = 1;
-		colorBlendStage.pAttachments = &colorBlendAttachment;
+		colorBlendStage.attachmentCount = DEFERRED_SHADING ? 2 : 1;
+		colorBlendStage.pAttachments = colorBlendAttachments.data();
 		colorBlendStage.blendConstants[0] = 0.0f; 
 		colorBlendStage.blendConstants[1] = 0.0f;
 		colorBlendStage.blendConstants[2] = 0.0f;
@@ -893,20 +2019,6 @@ private:
 		//dynamicStage.dynamicStateCount = 3;
 		//dynamicStage.pDynamicStates = dynamicStages;
 
-		//߲
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &_descriptorSetLayout;
-		pipelineLayoutInfo.pushConstantRangeCount = 0;
-		pipelineLayoutInfo.pPushConstantRanges = nullptr;
-
-		if (vkCreatePipelineLayout(_vkDevice, &pipelineLayoutInfo, nullptr, &_pipelineLayout)
-			!= VK_SUCCESS)
-		{
-			throw std::runtime_error("failed to create pipeline layout!");
-		}
-
 		VkGraphicsPipelineCreateInfo pipelineInfo = {};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 		pipelineInfo.stageCount = 2;
@@ -924,17 +2036,23 @@ private:
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 		pipelineInfo.basePipelineIndex = -1;
-		if (vkCreateGraphicsPipelines(_vkDevice, VK_NULL_HANDLE, 1, &pipelineInfo,
-			nullptr, &_graphicPipeline) != VK_SUCCESS)
-		{
-			throw std::runtime_error("failed to create graphics pipeline!");
-		}
+		VkPipeline graphicPipeline = VK_NULL_HANDLE;
+		VkResult result = vkCreateGraphicsPipelines(_vkDevice, _pipelineCache, 1, &pipelineInfo,
+			nullptr, &graphicPipeline);
 
 		vkDestroyShaderModule(_vkDevice, fragShaderModule, nullptr);
 		vkDestroyShaderModule(_vkDevice, vertShaderModule, nullptr);
+
+		if (result != VK_SUCCESS)
+		{
+			Logger::instance().log(LogSeverity::Warning, 0, "failed to create graphics pipeline variant!");
+			return VK_NULL_HANDLE;
+		}
+		return graphicPipeline;
 	}
 
-	VkShaderModule createShaderModule(const std::vector<char>& code)
+	//codeֱָӳԴ,еݿ鰴64ֽڶ
+	VkShaderModule createShaderModule(std::span<const uint8_t> code)
 	{
 		VkShaderModuleCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -952,88 +2070,264 @@ private:
 
 	void createRenderPass()
 	{
+		TRACE_FUNCTION();
+		if (DEFERRED_SHADING)
+		{
+			createDeferredRenderPass();
+			return;
+		}
+		bool multisampled = _msaaSamples != VK_SAMPLE_COUNT_1_BIT;
+
+		//زʱɫsubpassʱresolveHDRͼƬ,Ҫ
+		//HDRͼƬʱתΪȡĲ
 		VkAttachmentDescription colorAttachment = {};
-		colorAttachment.format = _swapChainImageFormat;
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		colorAttachment.format = HDR_FORMAT;
+		colorAttachment.samples = _msaaSamples;
 		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE
+			: VK_ATTACHMENT_STORE_OP_STORE;
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+			: VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkAttachmentDescription depthAttachment = {};
+		depthAttachment.format = _depthFormat;
+		depthAttachment.samples = _msaaSamples;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentDescription colorAttachmentResolve = {};
+		colorAttachmentResolve.format = HDR_FORMAT;
+		colorAttachmentResolve.samples = VK_SAMPLE_COUNT_1_BIT;
+		colorAttachmentResolve.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colorAttachmentResolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
 		VkAttachmentReference colorAttachmentRef = {};
 		colorAttachmentRef.attachment = 0;
 		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+		VkAttachmentReference depthAttachmentRef = {};
+		depthAttachmentRef.attachment = 1;
+		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference colorAttachmentResolveRef = {};
+		colorAttachmentResolveRef.attachment = 2;
+		colorAttachmentResolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
 		VkSubpassDescription subpass = {};
 		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 		subpass.colorAttachmentCount = 1;
 		subpass.pColorAttachments = &colorAttachmentRef;
+		subpass.pDepthStencilAttachment = &depthAttachmentRef;
+		subpass.pResolveAttachments = multisampled ? &colorAttachmentResolveRef : nullptr;
+
+		std::array<VkAttachmentDescription, 3> attachments = {
+			colorAttachment, depthAttachment, colorAttachmentResolve
+		};
 
 		VkRenderPassCreateInfo renderPassInfo = {};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassInfo.attachmentCount = 1;
-		renderPassInfo.pAttachments = &colorAttachment;
+		renderPassInfo.attachmentCount = multisampled ? 3 : 2;
+		renderPassInfo.pAttachments = attachments.data();
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpass;
 
-		VkSubpassDependency dependency = {};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstAccessMask= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		//HDRͼƬд֮ǰ,һ֡ĺ;Ҫһ֡д
+		std::array<VkSubpassDependency, 2> dependencies = {};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+			| VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[0].dstAccessMask= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+			| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		//ɫԺĲɼ
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
 
 		if (vkCreateRenderPass(_vkDevice, &renderPassInfo, nullptr,
 			&_renderPass) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create render pass!");
 		}
-
-		
 	}
 
-	void createFramebuffers()
+	//: 0HDRս,1,23G-buffer
+	//G-bufferֻsubpass 1Ϊinput attachmentȡ,STORE_OP_DONT_CAREtileڴ
+	void createDeferredRenderPass()
 	{
-		_swapChainFramembuffers.resize(_swapChainImageViews.size());
+		auto attachment = [](VkFormat format, VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp,
+			VkImageLayout finalLayout)
+		{
+			VkAttachmentDescription description = {};
+			description.format = format;
+			description.samples = VK_SAMPLE_COUNT_1_BIT;
+			description.loadOp = loadOp;
+			description.storeOp = storeOp;
+			description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			description.finalLayout = finalLayout;
+			return description;
+		};
+		//HDRÿضɹsubpassд,Ҫ
+		std::array<VkAttachmentDescription, 4> attachments = {
+			attachment(HDR_FORMAT, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_STORE,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			attachment(_depthFormat, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL),
+			attachment(GBUFFER_ALBEDO_FORMAT, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			attachment(GBUFFER_NORMAL_FORMAT, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+		};
+
+		std::array<VkAttachmentReference, 2> gbufferRefs = { {
+			{ 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+			{ 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL } } };
+		VkAttachmentReference depthRef = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+		//˳lighting.fraginput_attachment_indexһ
+		std::array<VkAttachmentReference, 3> inputRefs = { {
+			{ 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ 3, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL } } };
+		VkAttachmentReference hdrRef = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		//Ӳȵд,ȿͬʱinput attachmentֻȸ
+		VkAttachmentReference readOnlyDepthRef = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+
+		std::array<VkSubpassDescription, 2> subpasses = {};
+		subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[0].colorAttachmentCount = static_cast<uint32_t>(gbufferRefs.size());
+		subpasses[0].pColorAttachments = gbufferRefs.data();
+		subpasses[0].pDepthStencilAttachment = &depthRef;
+		subpasses[LIGHTING_SUBPASS].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[LIGHTING_SUBPASS].inputAttachmentCount = static_cast<uint32_t>(inputRefs.size());
+		subpasses[LIGHTING_SUBPASS].pInputAttachments = inputRefs.data();
+		subpasses[LIGHTING_SUBPASS].colorAttachmentCount = 1;
+		subpasses[LIGHTING_SUBPASS].pColorAttachments = &hdrRef;
+		subpasses[LIGHTING_SUBPASS].pDepthStencilAttachment = &readOnlyDepthRef;
+
+		std::array<VkSubpassDependency, 4> dependencies = {};
+		//һ֡subpassG-bufferȡsubpassдܸ֮
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+			| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		//HDRͼƬд֮ǰ,һ֡ĺ
+		dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].dstSubpass = LIGHTING_SUBPASS;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[1].srcAccessMask = 0;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+		//ֻȡͬһ,,tile GPUϲҪG-bufferдԴ
+		dependencies[2].srcSubpass = 0;
+		dependencies[2].dstSubpass = LIGHTING_SUBPASS;
+		dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			| VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+			| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[2].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+			| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependencies[2].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT
+			| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+		dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		//ɫԺĲɼ
+		dependencies[3].srcSubpass = LIGHTING_SUBPASS;
+		dependencies[3].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[3].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[3].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[3].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[3].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-		size_t fbCount = _swapChainFramembuffers.size();
-		for (size_t i = 0; i < fbCount; ++i)
+		VkRenderPassCreateInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+		renderPassInfo.pSubpasses = subpasses.data();
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
+
+		if (vkCreateRenderPass(_vkDevice, &renderPassInfo, nullptr,
+			&_renderPass) != VK_SUCCESS)
 		{
-			VkImageView attachments[]={
-				_swapChainImageViews[i]
-			};
+			throw std::runtime_error("failed to create render pass!");
+		}
+	}
 
-			VkFramebufferCreateInfo framebufferInfo = {};
-			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = _renderPass;
-			framebufferInfo.attachmentCount = 1;
-			framebufferInfo.pAttachments = attachments;
-			framebufferInfo.width = _swapChainExtent.width;
-			framebufferInfo.height = _swapChainExtent.height;
-			framebufferInfo.layers = 1;
-
-			if (vkCreateFramebuffer(_vkDevice, &framebufferInfo,
-				nullptr,&_swapChainFramembuffers[i]) != VK_SUCCESS)
-			{
-				throw std::runtime_error("failed to create framebuffer!");
-			}
+	//ֻȾHDRĿ,뽻ͼƬ޹,һ֡͹
+	void createSceneFramebuffer()
+	{
+		TRACE_FUNCTION();
+		//˳createRenderPassһ
+		std::vector<VkImageView> attachments;
+		if (DEFERRED_SHADING)
+		{
+			attachments = { _hdrImageView, _depthImageView, _gbufferImageViews[0], _gbufferImageViews[1] };
+		}
+		else if (_msaaSamples != VK_SAMPLE_COUNT_1_BIT)
+		{
+			attachments = { _colorImageView, _depthImageView, _hdrImageView };
+		}
+		else
+		{
+			attachments = { _hdrImageView, _depthImageView };
+		}
 
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = _renderPass;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		framebufferInfo.pAttachments = attachments.data();
+		framebufferInfo.width = _swapChainExtent.width;
+		framebufferInfo.height = _swapChainExtent.height;
+		framebufferInfo.layers = 1;
+
+		if (vkCreateFramebuffer(_vkDevice, &framebufferInfo,
+			nullptr, &_sceneFramebuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create framebuffer!");
 		}
 	}
 
 	void createCommandPool()
 	{
+		TRACE_FUNCTION();
 		QueueFamilyIndices queueFamilyIndices = findQueueFamilies(_physicalDevice);
 
 		VkCommandPoolCreateInfo poolInfo = {};
 		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
-		poolInfo.flags = 0;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 		if (vkCreateCommandPool(_vkDevice, &poolInfo, nullptr, &_commandPool)
 			!= VK_SUCCESS)
 		{
@@ -1041,413 +2335,2480 @@ private:
 		}
 	}
 
-	void createCommandBuffers()
+	//ָÿ֡һ,ȵ֡ͼύɺ¼
+	void createComputeCommandBuffers()
 	{
-		_commandBuffers.resize(_swapChainFramembuffers.size());
+		TRACE_FUNCTION();
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = _computeQueueFamily;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		if (vkCreateCommandPool(_vkDevice, &poolInfo, nullptr, &_computeCommandPool)
+			!= VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create compute command pool!");
+		}
 
 		VkCommandBufferAllocateInfo allocInfo = {};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.commandBufferCount = (uint32_t)_commandBuffers.size();
-		allocInfo.commandPool = _commandPool;
+		allocInfo.commandBufferCount = static_cast<uint32_t>(_computeCommandBuffers.size());
+		allocInfo.commandPool = _computeCommandPool;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-		if (vkAllocateCommandBuffers(_vkDevice, &allocInfo,
-			_commandBuffers.data()) != VK_SUCCESS)
+		if (vkAllocateCommandBuffers(_vkDevice, &allocInfo, _computeCommandBuffers.data()) != VK_SUCCESS)
 		{
-			throw std::runtime_error("failed to create command buffers!");
+			throw std::runtime_error("failed to allocate compute command buffers!");
 		}
 
-		size_t commandBufferCount = _commandBuffers.size();
-		for (size_t i = 0; i < commandBufferCount; ++i)
-		{
-			VkCommandBufferBeginInfo beginInfo = {};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-			beginInfo.pInheritanceInfo = nullptr;
-			if (vkBeginCommandBuffer(_commandBuffers[i], &beginInfo)
-				!=VK_SUCCESS)
-			{
-				throw std::runtime_error("failed to create begin recording command buffer!");
-			}
-
-			//ʼȾ
-			VkRenderPassBeginInfo renderPassInfo = {};
-			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassInfo.renderPass = _renderPass;
-			renderPassInfo.framebuffer = _swapChainFramembuffers[i];
-			renderPassInfo.renderArea.offset = {0,0};
-			renderPassInfo.renderArea.extent = _swapChainExtent;
-			VkClearValue clearColor = {0.2,0.2,0.2,1.0};
-			renderPassInfo.clearValueCount = 1;
-			renderPassInfo.pClearValues = &clearColor;
-
-			vkCmdBeginRenderPass(_commandBuffers[i],&renderPassInfo,VK_SUBPASS_CONTENTS_INLINE);
-			//vkCmdSetViewport(_commandBuffers[i], 0, 1,&_viewport);
-			//vkCmdSetScissor(_commandBuffers[i], 0, 1, &_scissor);
-			//vkCmdSetLineWidth(_commandBuffers[i], 1.0);
-			vkCmdBindPipeline(_commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicPipeline);
-			VkBuffer vertexBuffers[] = {_vertexBuffer};
-			VkDeviceSize offsets[] = {0};
-			vkCmdBindVertexBuffers(_commandBuffers[i],0,1, vertexBuffers,offsets);
-			vkCmdBindIndexBuffer(_commandBuffers[i],_indexBuffer,0,VK_INDEX_TYPE_UINT16);
-			//vkCmdDraw(_commandBuffers[i], 
-			//	static_cast<uint32_t>(vertices.size()), 1, 0,0);
-			vkCmdBindDescriptorSets(_commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS
-				, _pipelineLayout, 0, 1, &_descriptorSets[i], 0, nullptr);
-			vkCmdDrawIndexed(_commandBuffers[i], static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-			vkCmdEndRenderPass(_commandBuffers[i]);
-
-			if (vkEndCommandBuffer(_commandBuffers[i]) != VK_SUCCESS)
-			{
-				throw std::runtime_error("failed to record command buffer!");
-			}
-		}
+		_computeTimeline.create(_vkDevice);
 	}
 
-	void createSyncObjects()
+	//ͼζв֧ʱʱѯ,GPUʱ䲻ͳ
+	void createTimestampQueryPool()
 	{
-		_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+		TRACE_FUNCTION();
+		QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
 
-		VkSemaphoreCreateInfo semaphoreInfo = {};
-		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		uint32_t validBits = queueFamilies[indices.graphicsFamily].timestampValidBits;
+		if (validBits == 0)
+			return;
 
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(_physicalDevice, &properties);
+		_timestampPeriod = properties.limits.timestampPeriod;
+		_timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
 
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		VkQueryPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * TIMESTAMPS_PER_FRAME;
+		if (vkCreateQueryPool(_vkDevice, &poolInfo, nullptr, &_timestampQueryPool) != VK_SUCCESS)
 		{
-			if (vkCreateSemaphore(_vkDevice, &semaphoreInfo, nullptr,
-				&_imageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(_vkDevice, &semaphoreInfo, nullptr,
-					&_renderFinishedSemaphores[i]) != VK_SUCCESS
-				||vkCreateFence(_vkDevice,&fenceInfo,nullptr,&_inFlightFences[i])!=VK_SUCCESS)
-			{
-				throw std::runtime_error("failed to create semaphores!");
-			}
+			throw std::runtime_error("failed to create timestamp query pool!");
 		}
 	}
 
-	void drawFrame()
+	void createCommandBuffers()
 	{
-		vkWaitForFences(_vkDevice,1,&_inFlightFences[_currentFrame],VK_TRUE,
-			std::numeric_limits<uint64_t>::max());
-		vkResetFences(_vkDevice, 1, &_inFlightFences[_currentFrame]);
+		TRACE_FUNCTION();
+		_commandBuffers.resize(_swapChainImages.size());
 
-		//ȡͼƬ
-		uint32_t imageIndex;
-		VkResult result= vkAcquireNextImageKHR(_vkDevice, _swapChain,
-			std::numeric_limits<uint64_t>::max()
-			, _imageAvailableSemaphores[_currentFrame], VK_NULL_HANDLE, &imageIndex);
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandBufferCount = (uint32_t)_commandBuffers.size();
+		allocInfo.commandPool = _commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR)
-		{
-			recreateSwapChain();
-			return;
-		}
-		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		if (vkAllocateCommandBuffers(_vkDevice, &allocInfo,
+			_commandBuffers.data()) != VK_SUCCESS)
 		{
-			throw std::runtime_error("failed to acquire swap chain image!");
+			throw std::runtime_error("failed to create command buffers!");
 		}
+	}
 
-		updateUniformBuffer(imageIndex);
+	//ÿ֡¼,ݺͼƶ仯
+	void recordCommandBuffer(uint32_t imageIndex)
+	{
+		TRACE_FUNCTION();
+		VkCommandBuffer commandBuffer = _commandBuffers[imageIndex];
+		vkResetCommandBuffer(commandBuffer, 0);
 
-		//ύָ
-		VkSemaphore waitSemaphores[] = { _imageAvailableSemaphores[_currentFrame] };
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = nullptr;
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo)
+			!=VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create begin recording command buffer!");
+		}
 
-		VkPipelineStageFlags waitStages[] = {
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-		};
-		VkSubmitInfo submitInfo = {};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = waitSemaphores;
-		submitInfo.pWaitDstStageMask = waitStages;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &_commandBuffers[imageIndex];
-		VkSemaphore signalSemaphores[] = {_renderFinishedSemaphores[_currentFrame]};
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = signalSemaphores;
+		uint32_t firstQuery = static_cast<uint32_t>(_currentFrame) * TIMESTAMPS_PER_FRAME;
+		if (_timestampQueryPool != VK_NULL_HANDLE)
+		{
+			vkCmdResetQueryPool(commandBuffer, _timestampQueryPool, firstQuery, TIMESTAMPS_PER_FRAME);
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _timestampQueryPool,
+				firstQuery + TIMESTAMP_FRAME_BEGIN);
+		}
 
-		if (vkQueueSubmit(_graphicsQueue, 1,
-			&submitInfo, _inFlightFences[_currentFrame]) != VK_SUCCESS)
+		//ʼȾ
+		VkRenderPassBeginInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = _renderPass;
+		renderPassInfo.framebuffer = _sceneFramebuffer;
+		renderPassInfo.renderArea.offset = {0,0};
+		renderPassInfo.renderArea.extent = _swapChainExtent;
+		//ӳɫʱɫдڲɫG-buffer,subpassԿհԭ
+		std::array<VkClearValue, 4> clearValues = {};
+		clearValues[0].color = {0.2f,0.2f,0.2f,1.0f};
+		clearValues[1].depthStencil = {1.0f,0};
+		clearValues[2].color = {0.2f,0.2f,0.2f,1.0f};
+		clearValues[3].color = {0.5f,0.5f,1.0f,1.0f};
+		renderPassInfo.clearValueCount = DEFERRED_SHADING ? 4 : 2;
+		renderPassInfo.pClearValues = clearValues.data();
+
+		//дӶ,ͼζϻȡȨ
+		VkBuffer particleBuffer = _bufferPool[_particleVertexBuffers[_currentFrame]].buffer;
+		if (_computeQueueFamily != _graphicsQueueFamily)
 		{
-			throw std::runtime_error("failed to submit \
-				draw command buffer!");
+			VkBufferMemoryBarrier acquire = queueOwnershipBarrier(particleBuffer, _computeQueueFamily, _graphicsQueueFamily);
+			acquire.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+			//Դ׶ʱߵĵȴ׶һ,ȡͷ֮
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr, 1, &acquire, 0, nullptr);
 		}
 
-		VkSwapchainKHR swapChains[] = {_swapChain};
-		VkPresentInfoKHR presentInfo = {};
-		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = signalSemaphores;
-		presentInfo.swapchainCount = 1;
-		presentInfo.pSwapchains = swapChains;
-		presentInfo.pImageIndices = &imageIndex;
-		presentInfo.pResults = nullptr;
-		result= vkQueuePresentKHR(_presentQueue, &presentInfo);
+		vkCmdBeginRenderPass(commandBuffer,&renderPassInfo,VK_SUBPASS_CONTENTS_INLINE);
+		//set 0ÿŽͼƬuniform buffer,set 1ҳͲʱ
+		//߹һ,ֻ֡һ
+		std::array<VkDescriptorSet, 2> sceneSets = {
+			_descriptorSetPool[_descriptorSets[imageIndex]].set,
+			_descriptorSetPool[_materialDescriptorSet].set };
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS
+			, _pipelineLayout, 0, static_cast<uint32_t>(sceneSets.size()), sceneSets.data(), 0, nullptr);
 
+		recordDrawList(commandBuffer, imageIndex);
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR
-			||result==VK_SUBOPTIMAL_KHR||_framebufferResized)
+		if (DEFERRED_SHADING)
 		{
-			_framebufferResized = false;
-			recreateSwapChain();
+			vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelinePool[_lightingPipeline]);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+				_lightingPipelineLayout, 0, 1, &_lightingDescriptorSet, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, _lightingPipelineLayout, _lightingInterface.pushConstantRanges[0].stageFlags,
+				0, sizeof(LightingParams), &_lightingParams);
+			vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 		}
-		else if (result != VK_SUCCESS)
+
+		VkDeviceSize offsets[] = {0};
+		//ֱӴӼɫдĻ,CPU
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelinePool[_particleGraphicsPipeline]);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+			_particleGraphicsPipelineLayout, 0, 1, &_descriptorSetPool[_descriptorSets[imageIndex]].set, 0, nullptr);
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &particleBuffer, offsets);
+		vkCmdDraw(commandBuffer, _particleParams.particleCount, 1, 0, 0);
+		vkCmdEndRenderPass(commandBuffer);
+
+		writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, firstQuery + TIMESTAMP_SCENE_END);
+		recordPostProcessing(commandBuffer, imageIndex, firstQuery);
+		writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, firstQuery + TIMESTAMP_FRAME_END);
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
 		{
-			throw std::runtime_error("failed to acquire swap chain image!");
+			throw std::runtime_error("failed to record command buffer!");
 		}
-
-		_currentFrame = (_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 	}
 
-	void recreateSwapChain()
+	//ռ֡г,
+	void buildDrawList()
 	{
-		int width = 0, height = 0;
-		while (width == 0 || height == 0)
+		TRACE_FUNCTION();
+		const FrameState& state = _frameStates.readBuffer();
+
+		//Ϊ1ʱռĵλĻϵ
+		float projectionScale = _swapChainExtent.height / (2.0f * std::tan(glm::radians(CAMERA_FOV_DEGREES) * 0.5f));
+
+		_drawList.clear();
+		VkBuffer vertexBuffer = _bufferPool[_vertexBuffer].buffer;
+		VkBuffer indexBuffer = _bufferPool[_indexBuffer].buffer;
+		for (const auto& object : state.drawObjects)
 		{
-			glfwGetFramebufferSize(_window,&width,&height);
-			glfwWaitEvents();
+			const Mesh& mesh = _meshPool[object.mesh];
+			float distance = viewDistance(state.view, object.data.model);
+			uint32_t lod = selectMeshLod(mesh, object, distance, projectionScale);
+			const MeshLod& range = mesh.lods[lod];
+			PipelineVariant variant = materialPipeline(object.data.materialIndex);
+			DrawPacket draw = { variant.pipeline, vertexBuffer, indexBuffer, range.indexCount, mesh.firstIndex + range.firstIndex,
+				static_cast<int32_t>(mesh.vertexOffset), object.data };
+			_drawList.add(makeSortKey(DRAW_PASS_OPAQUE, variant.id, object.data.materialIndex,
+				(object.mesh.index << SORT_KEY_LOD_BITS) | lod, normalizedDepth(distance)), draw);
 		}
 
-		vkDeviceWaitIdle(_vkDevice);
+		//̬εĶͬһʽ
+		VkBuffer dynamicBuffer = _dynamicGeometry.buffer();
+		for (const auto& object : _dynamicDrawObjects)
+		{
+			PipelineVariant variant = materialPipeline(object.data.materialIndex);
+			DrawPacket draw = { variant.pipeline, dynamicBuffer, dynamicBuffer, object.mesh.indexCount, object.mesh.firstIndex,
+				static_cast<int32_t>(object.mesh.vertexOffset), object.data };
+			_drawList.add(makeSortKey(DRAW_PASS_OPAQUE, variant.id, object.data.materialIndex,
+				DYNAMIC_MESH_KEY, normalizedDepth(viewDistance(state.view, object.data.model))), draw);
+		}
 
-		cleanupSwapChain();
+		if (_drawList.size() > MAX_DRAW_OBJECTS)
+		{
+			throw std::runtime_error("too many draw objects!");
+		}
 
-		createSwapChain();
-		createImageViews();
-		createRenderPass();
-		createGraphicsPipeline();
-		createFramebuffers();
-		createCommandBuffers();
+		_drawList.sort(_drawSorter);
+		buildDrawBatches();
 	}
 
-	void cleanupSwapChain()
+	//ҹߺͼλͬĻƺϲһ,
+	//ͬһͬһڻٺϲһʵ,ǵ
+	void buildDrawBatches()
 	{
-		for (auto framebuffer : _swapChainFramembuffers)
+		_drawBatches.clear();
+		_drawCommands.clear();
+		for (size_t i = 0; i < _drawList.size(); ++i)
 		{
-			vkDestroyFramebuffer(_vkDevice, framebuffer, nullptr);
-		}
+			const DrawPacket& draw = _drawList[i];
+			if (_drawBatches.empty() || _drawBatches.back().pipeline != draw.pipeline
+				|| _drawBatches.back().vertexBuffer != draw.vertexBuffer
+				|| _drawBatches.back().indexBuffer != draw.indexBuffer)
+			{
+				_drawBatches.push_back({ draw.pipeline, draw.vertexBuffer, draw.indexBuffer,
+					static_cast<uint32_t>(_drawCommands.size()), 0 });
+			}
 
-		vkFreeCommandBuffers(_vkDevice, _commandPool,
+			DrawBatch& batch = _drawBatches.back();
+			if (batch.commandCount > 0)
+			{
+				//pixel.fragòʵҳ,ֻͬһڵǶ̬һµ,
+				//ֻϲҲͬʵ;һʵĵi-1
+				VkDrawIndexedIndirectCommand& previous = _drawCommands.back();
+				if (previous.indexCount == draw.indexCount && previous.firstIndex == draw.firstIndex
+					&& previous.vertexOffset == draw.vertexOffset
+					&& _drawList[i - 1].data.materialIndex == draw.data.materialIndex)
+				{
+					++previous.instanceCount;
+					continue;
+				}
+			}
+
+			VkDrawIndexedIndirectCommand command = {};
+			command.indexCount = draw.indexCount;
+			command.instanceCount = 1;
+			command.firstIndex = draw.firstIndex;
+			command.vertexOffset = draw.vertexOffset;
+			command.firstInstance = static_cast<uint32_t>(i);
+			_drawCommands.push_back(command);
+			++batch.commandCount;
+		}
+	}
+
+	//ʱ־ػĹ߱,һʱں̨,ǰͨñ
+	PipelineVariant materialPipeline(uint32_t materialIndex)
+	{
+		GraphicsPipelineState state = {};
+		state.materialVariant = MATERIAL_SPECIALIZED | _materialFlags[materialIndex];
+		return _pipelineManager.get(hashBytes(&state, sizeof(state)), state);
+	}
+
+	//ԭ߷ľ
+	static float viewDistance(const glm::mat4& view, const glm::mat4& model)
+	{
+		return -(view * model[3]).z;
+	}
+
+	//һԶƽ֮
+	static float normalizedDepth(float distance)
+	{
+		return (distance - CAMERA_NEAR) / (CAMERA_FAR - CAMERA_NEAR);
+	}
+
+	//ѡͶӰĻϵֵһLOD,һ֡ѡ񱣴_objectLodsڳ
+	//侫ϸЧ,ҪԵֵ,ֵͣľʱ֡л
+	uint32_t selectMeshLod(const Mesh& mesh, const DrawObject& object, float distance, float projectionScale)
+	{
+		if (object.objectIndex >= _objectLods.size())
+		{
+			_objectLods.resize(object.objectIndex + 1, 0);
+		}
+
+		//LODռж,ģ;
+		float scale = std::max({ glm::length(glm::vec3(object.data.model[0])),
+			glm::length(glm::vec3(object.data.model[1])), glm::length(glm::vec3(object.data.model[2])) });
+		float pixelsPerUnit = scale * projectionScale / std::max(distance, CAMERA_NEAR);
+
+		uint32_t lod = std::min<uint32_t>(_objectLods[object.objectIndex], mesh.lodCount - 1);
+		while (lod > 0 && mesh.lods[lod].error * pixelsPerUnit > LOD_ERROR_THRESHOLD)
+		{
+			--lod;
+		}
+		while (lod + 1 < mesh.lodCount
+			&& mesh.lods[lod + 1].error * pixelsPerUnit < LOD_ERROR_THRESHOLD * (1.0f - LOD_HYSTERESIS))
+		{
+			++lod;
+		}
+
+		_objectLods[object.objectIndex] = static_cast<uint8_t>(lod);
+		return lod;
+	}
+
+	//ÿֻһ״̬,֧multiDrawIndirectʱһμӻ
+	void recordDrawList(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+	{
+		TRACE_FUNCTION();
+		//ݰ˳д,±еfirstInstance
+		const DrawBuffers& buffers = _drawBuffers[imageIndex];
+		//ģͿռ+Z,תþ任,ǾʱԴֱڱ
+		for (size_t i = 0; i < _drawList.size(); ++i)
+		{
+			ObjectData object = _drawList[i].data;
+			object.normal = glm::normalize(glm::transpose(glm::inverse(glm::mat3(object.model))) * glm::vec3(0.0f, 0.0f, 1.0f));
+			buffers.objects[i] = object;
+		}
+		memcpy(buffers.commands, _drawCommands.data(), _drawCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
+
+		VkBuffer indirectBuffer = _bufferPool[buffers.indirectBuffer].buffer;
+		VkPipeline boundPipeline = VK_NULL_HANDLE;
+		VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+		VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		for (const auto& batch : _drawBatches)
+		{
+			if (batch.pipeline != boundPipeline)
+			{
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline);
+				boundPipeline = batch.pipeline;
+			}
+			if (batch.vertexBuffer != boundVertexBuffer)
+			{
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, &batch.vertexBuffer, &offset);
+				boundVertexBuffer = batch.vertexBuffer;
+			}
+			if (batch.indexBuffer != boundIndexBuffer)
+			{
+				vkCmdBindIndexBuffer(commandBuffer, batch.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+				boundIndexBuffer = batch.indexBuffer;
+			}
+
+			if (_multiDrawIndirectSupported)
+			{
+				//maxDrawIndirectCountʱɶ
+				for (uint32_t first = 0; first < batch.commandCount; first += _maxDrawIndirectCount)
+				{
+					uint32_t count = std::min(batch.commandCount - first, _maxDrawIndirectCount);
+					vkCmdDrawIndexedIndirect(commandBuffer, indirectBuffer,
+						(batch.firstCommand + first) * sizeof(VkDrawIndexedIndirectCommand),
+						count, sizeof(VkDrawIndexedIndirectCommand));
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0; i < batch.commandCount; ++i)
+				{
+					const VkDrawIndexedIndirectCommand& command = _drawCommands[batch.firstCommand + i];
+					vkCmdDrawIndexed(commandBuffer, command.indexCount, command.instanceCount,
+						command.firstIndex, command.vertexOffset, command.firstInstance);
+				}
+			}
+		}
+	}
+
+	void createSyncObjects()
+	{
+		TRACE_FUNCTION();
+		_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+		_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		{
+			if (vkCreateSemaphore(_vkDevice, &semaphoreInfo, nullptr,
+				&_imageAvailableSemaphores[i]) != VK_SUCCESS ||
+				vkCreateSemaphore(_vkDevice, &semaphoreInfo, nullptr,
+					&_renderFinishedSemaphores[i]) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to create semaphores!");
+			}
+		}
+
+		//֡ʱ,ÿ֡fence
+		_frameTimeline.create(_vkDevice);
+		_frameTimelineValues.fill(0);
+	}
+
+	//ģʱ仯˵жڽ,涼ҪȾ
+	void pollFrameState()
+	{
+		TRACE_FUNCTION();
+		if (!_frameStates.update())
+			return;
+
+		float time = _frameStates.readBuffer().time;
+		if (time != _frameStateTime)
+		{
+			_frameStateTime = time;
+			_damageTracker.invalidate();
+		}
+	}
+
+	void drawFrame()
+	{
+		TRACE_FUNCTION();
+		bool render = !enableOnDemandRendering || _damageTracker.hasDamage() || _framebufferResized
+			|| _exposureAdapting;
+		if (!render && !_refreshRequested)
+			return;
+		_refreshRequested = false;
+		auto frameStart = FrameStats::Clock::now();
+		double fenceWait = 0.0;
+
+		//ֻȴ֡λһύʱֵ
+		{
+			TRACE_ZONE("waitFrameTimeline");
+			_frameTimeline.wait(_frameTimelineValues[_currentFrame]);
+		}
+		fenceWait += millisecondsSince(frameStart);
+		_destructionQueue.collect(_frameTimeline.completedValue());
+		reclaimUploads();
+		collectFrameTimings(_currentFrame);
+		checkExposureConverged(_currentFrame);
+
+		//ȡͼƬ
+		uint32_t imageIndex;
+		VkResult result;
+		auto acquireStart = FrameStats::Clock::now();
+		{
+			TRACE_ZONE("vkAcquireNextImageKHR");
+			result= vkAcquireNextImageKHR(_vkDevice, _swapChain,
+				std::numeric_limits<uint64_t>::max()
+				, _imageAvailableSemaphores[_currentFrame], VK_NULL_HANDLE, &imageIndex);
+		}
+		_acquireTime = FrameStats::Clock::now();
+		double acquireWait = millisecondsSince(acquireStart);
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			recreateSwapChain();
+			return;
+		}
+		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		{
+			throw std::runtime_error("failed to acquire swap chain image!");
+		}
+
+		//ûб仯ҸͼƬ,Ⱦֱӳ
+		if (!render && _damageTracker.isCurrent(imageIndex))
+		{
+			presentUnchanged(imageIndex);
+			_currentFrame = (_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+			return;
+		}
+
+		//ͼƬڷ֡ʱ,ͼƬԱ֡ʹ
+		auto imageWaitStart = FrameStats::Clock::now();
+		{
+			TRACE_ZONE("waitImageInFlight");
+			_frameTimeline.wait(_imagesInFlight[imageIndex]);
+		}
+		fenceWait += millisecondsSince(imageWaitStart);
+
+		updateUniformBuffer(imageIndex);
+		buildDrawList();
+		recordCommandBuffer(imageIndex);
+
+		//ύ֮֡ǰ¼Ƶϴ,֡GPUϵȴϴ
+		flushUploads();
+		uint64_t particleValue = submitParticleSimulation();
+
+		//ύָ,ģֻڶ׶εȴ
+		VkSemaphore waitSemaphores[] = {
+			_imageAvailableSemaphores[_currentFrame],
+			_transferTimeline.semaphore(),
+			_computeTimeline.semaphore()
+		};
+
+		//ͼƬһдɫӳblit
+		VkPipelineStageFlags waitStages[] = {
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+		};
+
+		uint64_t frameValue = _frameTimeline.nextValue();
+		VkSemaphore signalSemaphores[] = {
+			_renderFinishedSemaphores[_currentFrame],
+			_frameTimeline.semaphore()
+		};
+		uint64_t waitValues[] = { 0, _transferTimeline.lastSubmittedValue(), particleValue };
+		uint64_t signalValues[] = { 0, frameValue };
+
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.waitSemaphoreValueCount = 3;
+		timelineInfo.pWaitSemaphoreValues = waitValues;
+		timelineInfo.signalSemaphoreValueCount = 2;
+		timelineInfo.pSignalSemaphoreValues = signalValues;
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = 3;
+		submitInfo.pWaitSemaphores = waitSemaphores;
+		submitInfo.pWaitDstStageMask = waitStages;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &_commandBuffers[imageIndex];
+		submitInfo.signalSemaphoreCount = 2;
+		submitInfo.pSignalSemaphores = signalSemaphores;
+
+		VkResult submitResult;
+		{
+			TRACE_ZONE("vkQueueSubmit");
+			submitResult = vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+		}
+		if (submitResult != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit \
+				draw command buffer!");
+		}
+
+		_frameTimelineValues[_currentFrame] = frameValue;
+		_imagesInFlight[imageIndex] = frameValue;
+		_exposureReadbackPending[_currentFrame] = true;
+
+		//عͷı,仯ķΧ
+		_damageTracker.commit(imageIndex);
+		presentImage(imageIndex, signalSemaphores[0], nullptr);
+		recordFrameStats(frameStart, fenceWait, acquireWait);
+
+		_currentFrame = (_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+	}
+
+	//¼κָĿύ: ȴacquireź,renderFinishedźŲƽ֡ʱ
+	//֡λͼƬʱֵճ,´θacquireź֮ǰĵȴһѾ
+	void presentUnchanged(uint32_t imageIndex)
+	{
+		TRACE_FUNCTION();
+		VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		uint64_t frameValue = _frameTimeline.nextValue();
+		VkSemaphore signalSemaphores[] = {
+			_renderFinishedSemaphores[_currentFrame],
+			_frameTimeline.semaphore()
+		};
+		uint64_t waitValue = 0;
+		uint64_t signalValues[] = { 0, frameValue };
+
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.waitSemaphoreValueCount = 1;
+		timelineInfo.pWaitSemaphoreValues = &waitValue;
+		timelineInfo.signalSemaphoreValueCount = 2;
+		timelineInfo.pSignalSemaphoreValues = signalValues;
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &_imageAvailableSemaphores[_currentFrame];
+		submitInfo.pWaitDstStageMask = &waitStage;
+		submitInfo.signalSemaphoreCount = 2;
+		submitInfo.pSignalSemaphores = signalSemaphores;
+		if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit present batch!");
+		}
+
+		_frameTimelineValues[_currentFrame] = frameValue;
+		_imagesInFlight[imageIndex] = frameValue;
+		presentImage(imageIndex, _renderFinishedSemaphores[_currentFrame], nullptr);
+	}
+
+	//damageһγֱ仯,֧incremental presentʱ߳
+	void presentImage(uint32_t imageIndex, VkSemaphore waitSemaphore, const VkRect2D* damage)
+	{
+		TRACE_FUNCTION();
+		VkSwapchainKHR swapChains[] = {_swapChain};
+		VkPresentInfoKHR presentInfo = {};
+		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		presentInfo.waitSemaphoreCount = 1;
+		presentInfo.pWaitSemaphores = &waitSemaphore;
+		presentInfo.swapchainCount = 1;
+		presentInfo.pSwapchains = swapChains;
+		presentInfo.pImageIndices = &imageIndex;
+		presentInfo.pResults = nullptr;
+
+		VkRectLayerKHR damageRect = {};
+		VkPresentRegionKHR presentRegion = {};
+		VkPresentRegionsKHR presentRegions = {};
+		if (_incrementalPresentSupported && damage != nullptr && damage->extent.width > 0)
+		{
+			damageRect.offset = damage->offset;
+			damageRect.extent = damage->extent;
+			damageRect.layer = 0;
+
+			presentRegion.rectangleCount = 1;
+			presentRegion.pRectangles = &damageRect;
+
+			presentRegions.sType = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR;
+			presentRegions.swapchainCount = 1;
+			presentRegions.pRegions = &presentRegion;
+			presentInfo.pNext = &presentRegions;
+		}
+
+		//presentID֮ѯʵʳʱһرεacquireʱ
+		VkPresentTimeGOOGLE presentTime = {};
+		VkPresentTimesInfoGOOGLE presentTimes = {};
+		if (_displayTimingSupported)
+		{
+			presentTime.presentID = ++_presentId;
+			presentTime.desiredPresentTime = 0;
+			_presentAcquireTimes[presentTime.presentID % PRESENT_HISTORY_SIZE] = _acquireTime;
+
+			presentTimes.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+			presentTimes.pNext = presentInfo.pNext;
+			presentTimes.swapchainCount = 1;
+			presentTimes.pTimes = &presentTime;
+			presentInfo.pNext = &presentTimes;
+		}
+
+		VkResult result;
+		{
+			TRACE_ZONE("vkQueuePresentKHR");
+			result= vkQueuePresentKHR(_presentQueue, &presentInfo);
+		}
+
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR
+			||result==VK_SUBOPTIMAL_KHR||_framebufferResized)
+		{
+			_framebufferResized = false;
+			recreateSwapChain();
+		}
+		else if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to present swap chain image!");
+		}
+		else if (_displayTimingSupported)
+		{
+			collectPresentationTimings();
+		}
+	}
+
+	//ʵʳʱsteady_clockͬΪCLOCK_MONOTONIC(Linux/Androidϵdisplay timingʵ)
+	void collectPresentationTimings()
+	{
+		uint32_t count = 0;
+		_getPastPresentationTiming(_vkDevice, _swapChain, &count, nullptr);
+		if (count == 0)
+			return;
+
+		_pastPresentationTimings.resize(count);
+		VkResult result = _getPastPresentationTiming(_vkDevice, _swapChain, &count, _pastPresentationTimings.data());
+		if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+			return;
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const VkPastPresentationTimingGOOGLE& timing = _pastPresentationTimings[i];
+			uint64_t acquire = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				_presentAcquireTimes[timing.presentID % PRESENT_HISTORY_SIZE].time_since_epoch()).count();
+			if (timing.actualPresentTime > acquire)
+				_frameStats.record(FRAME_METRIC_PRESENT_LATENCY, (timing.actualPresentTime - acquire) / 1000000.0);
+		}
+	}
+
+	static double millisecondsSince(FrameStats::Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(FrameStats::Clock::now() - start).count();
+	}
+
+	//ڸ֡λʱߵȴ֮,ʱѯһѾ
+	void collectFrameTimings(size_t frame)
+	{
+		if (!_frameStatsPending[frame])
+			return;
+		_frameStatsPending[frame] = false;
+
+		double gpuTime = 0.0;
+		if (_timestampQueryPool != VK_NULL_HANDLE)
+		{
+			uint64_t timestamps[TIMESTAMPS_PER_FRAME] = {};
+			if (vkGetQueryPoolResults(_vkDevice, _timestampQueryPool, static_cast<uint32_t>(frame) * TIMESTAMPS_PER_FRAME,
+				TIMESTAMPS_PER_FRAME, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+			{
+				auto elapsed = [&](uint32_t begin, uint32_t end)
+				{
+					uint64_t ticks = (timestamps[end] - timestamps[begin]) & _timestampMask;
+					return ticks * static_cast<double>(_timestampPeriod) / 1000000.0;
+				};
+				gpuTime = elapsed(TIMESTAMP_FRAME_BEGIN, TIMESTAMP_FRAME_END);
+				_frameStats.record(FRAME_METRIC_GPU, gpuTime);
+
+				std::array<double, 3> postTimes = {
+					elapsed(TIMESTAMP_SCENE_END, TIMESTAMP_LUMINANCE_END),
+					elapsed(TIMESTAMP_LUMINANCE_END, TIMESTAMP_BLOOM_END),
+					elapsed(TIMESTAMP_BLOOM_END, TIMESTAMP_FRAME_END) };
+				_frameStats.record(FRAME_METRIC_POST_LUMINANCE, postTimes[0]);
+				_frameStats.record(FRAME_METRIC_POST_BLOOM, postTimes[1]);
+				_frameStats.record(FRAME_METRIC_POST_TONEMAP, postTimes[2]);
+
+				//ֻڳԤ״̬仯ʱ¼,ÿ֡ˢ
+				bool overBudget = *std::max_element(postTimes.begin(), postTimes.end()) > POST_STAGE_BUDGET_MS;
+				if (overBudget && !_postOverBudget)
+				{
+					Logger::instance().log(LogSeverity::Warning, 0, "post processing stage exceeds its GPU budget!");
+				}
+				_postOverBudget = overBudget;
+			}
+		}
+
+		//ûʵʳʱ,ֵȴɨʱ
+		if (!_displayTimingSupported)
+		{
+			_frameStats.record(FRAME_METRIC_PRESENT_LATENCY, _estimatedLatency[frame] + gpuTime);
+		}
+	}
+
+	//֮¼֡CPUʱ䡢ȴʱ֡
+	void recordFrameStats(FrameStats::Clock::time_point frameStart, double fenceWait, double acquireWait)
+	{
+		auto now = FrameStats::Clock::now();
+		double frameTime = std::chrono::duration<double, std::milli>(now - frameStart).count();
+		_frameStats.record(FRAME_METRIC_CPU, frameTime - fenceWait - acquireWait);
+		_frameStats.record(FRAME_METRIC_FENCE_WAIT, fenceWait);
+
+		_estimatedLatency[_currentFrame] = std::chrono::duration<double, std::milli>(now - _acquireTime).count();
+		_frameStatsPending[_currentFrame] = true;
+
+		//Ⱦ֮ĵһ֡֡
+		double interval = std::chrono::duration<double>(now - _lastPresentTime).count();
+		if (interval < FRAME_STATS_IDLE_THRESHOLD)
+		{
+			_frameStats.recordFrameInterval(interval * 1000.0);
+		}
+		_lastPresentTime = now;
+	}
+
+	//ÿˢ±ϵĶ,дϵͳɼļ
+	void updateFrameStats()
+	{
+		if (!_frameStats.update())
+			return;
+
+		std::string title = "Vulkan | " + _frameStats.summary();
+		glfwSetWindowTitle(_window, title.c_str());
+
+		auto now = FrameStats::Clock::now();
+		if (std::chrono::duration<double>(now - _lastFrameStatsDump).count() >= FRAME_STATS_DUMP_INTERVAL)
+		{
+			_lastFrameStatsDump = now;
+			_frameStats.appendCsv(FRAME_STATS_CSV_PATH);
+			_frameStats.writeJson(FRAME_STATS_JSON_PATH);
+		}
+	}
+
+	void recreateSwapChain()
+	{
+		TRACE_FUNCTION();
+		int width = 0, height = 0;
+		while (width == 0 || height == 0)
+		{
+			glfwGetFramebufferSize(_window,&width,&height);
+			glfwWaitEvents();
+		}
+
+		vkDeviceWaitIdle(_vkDevice);
+
+		cleanupSwapChain();
+
+		createSwapChain();
+		createImageViews();
+		createRenderPass();
+		createGraphicsPipeline();
+		createParticleGraphicsPipeline();
+		createLightingPipeline();
+		createColorResources();
+		createDepthResources();
+		createGBufferResources();
+		createHdrResources();
+		createSceneFramebuffer();
+		createPostDescriptorSets();
+		createLightingDescriptorSet();
+		createCommandBuffers();
+	}
+
+	void cleanupSwapChain()
+	{
+		if (_msaaSamples != VK_SAMPLE_COUNT_1_BIT)
+		{
+			vkDestroyImageView(_vkDevice, _colorImageView, nullptr);
+			vkDestroyImage(_vkDevice, _colorImage, nullptr);
+			vkFreeMemory(_vkDevice, _colorImageMemory, nullptr);
+		}
+
+		vkDestroyImageView(_vkDevice, _depthImageView, nullptr);
+		vkDestroyImage(_vkDevice, _depthImage, nullptr);
+		vkFreeMemory(_vkDevice, _depthImageMemory, nullptr);
+
+		if (DEFERRED_SHADING)
+		{
+			vkDestroyDescriptorPool(_vkDevice, _lightingDescriptorPool, nullptr);
+			for (size_t i = 0; i < _gbufferImages.size(); ++i)
+			{
+				vkDestroyImageView(_vkDevice, _gbufferImageViews[i], nullptr);
+				vkDestroyImage(_vkDevice, _gbufferImages[i], nullptr);
+				vkFreeMemory(_vkDevice, _gbufferImageMemory[i], nullptr);
+			}
+			releasePipeline(_lightingPipeline);
+		}
+
+		vkDestroyFramebuffer(_vkDevice, _sceneFramebuffer, nullptr);
+
+		//豸ѿ,мͼƬֱ
+		vkDestroyDescriptorPool(_vkDevice, _postDescriptorPool, nullptr);
+		releaseBuffer(_luminanceBuffer);
+		vkDestroyImageView(_vkDevice, _hdrImageView, nullptr);
+		vkDestroyImage(_vkDevice, _hdrImage, nullptr);
+		vkFreeMemory(_vkDevice, _hdrImageMemory, nullptr);
+		for (size_t i = 0; i < _bloomImages.size(); ++i)
+		{
+			vkDestroyImageView(_vkDevice, _bloomImageViews[i], nullptr);
+			vkDestroyImage(_vkDevice, _bloomImages[i], nullptr);
+			vkFreeMemory(_vkDevice, _bloomImageMemory[i], nullptr);
+		}
+		if (_ldrImage != VK_NULL_HANDLE)
+		{
+			vkDestroyImageView(_vkDevice, _ldrImageView, nullptr);
+			vkDestroyImage(_vkDevice, _ldrImage, nullptr);
+			vkFreeMemory(_vkDevice, _ldrImageMemory, nullptr);
+			_ldrImage = VK_NULL_HANDLE;
+		}
+
+		vkFreeCommandBuffers(_vkDevice, _commandPool,
 			static_cast<uint32_t>(_commandBuffers.size()), _commandBuffers.data());
 
-		vkDestroyPipeline(_vkDevice, _graphicPipeline, nullptr);
-		vkDestroyPipelineLayout(_vkDevice, _pipelineLayout, nullptr);
-		vkDestroyRenderPass(_vkDevice, _renderPass, nullptr);
-		for (auto imageView : _swapChainImageViews)
+		//ؽȾͨͲܲͬ,ػȫ,֮±
+		VkDevice device = _vkDevice;
+		for (VkPipeline pipeline : _pipelineManager.reset())
+		{
+			_destructionQueue.push(releaseTimelineValue(), [device, pipeline]()
+			{
+				vkDestroyPipeline(device, pipeline, nullptr);
+			});
+		}
+		releasePipeline(_particleGraphicsPipeline);
+		releasePipeline(_graphicPipeline);
+		vkDestroyRenderPass(_vkDevice, _renderPass, nullptr);
+		for (auto imageView : _swapChainImageViews)
+		{
+			vkDestroyImageView(_vkDevice, imageView, nullptr);
+		}
+
+		vkDestroySwapchainKHR(_vkDevice, _swapChain, nullptr);
+	}
+
+	bool hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+	{
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &memProperties);
+
+		for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i)
+		{
+			if (typeFilter&(1 << i) && (memProperties
+				.memoryTypes[i].propertyFlags&properties) == properties)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	uint32_t findMemoryType(uint32_t typeFilter,VkMemoryPropertyFlags properties)
+	{
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(_physicalDevice,&memProperties);
+
+		for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i)
+		{
+			if (typeFilter&(1 << i) && (memProperties
+				.memoryTypes[i].propertyFlags&properties) == properties)
+			{
+				return i;
+			}	
+		}
+
+		throw std::runtime_error("failed to find suitable memory type!");
+	}
+
+	void createVertexBuffer()
+	{
+		TRACE_FUNCTION();
+		VkDeviceSize bufferSize = sizeof(Vertex)*GEOMETRY_VERTEX_CAPACITY;
+
+		_vertexBuffer = createBufferResource(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT|
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		_vertexAllocator.init(GEOMETRY_VERTEX_CAPACITY);
+	}
+
+	void createBuffer(VkDeviceSize size,VkBufferUsageFlags usage,
+		VkMemoryPropertyFlags properties,VkBuffer& buffer,VkDeviceMemory& bufferMemory)
+	{
+		VkBufferCreateInfo bufferInfo={};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateBuffer(_vkDevice, &bufferInfo, nullptr, &buffer)
+			!= VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create buffer!");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(_vkDevice, buffer, &memRequirements);
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memRequirements.size;
+		allocInfo.memoryTypeIndex = findMemoryType(
+			memRequirements.memoryTypeBits,properties);
+
+		if (vkAllocateMemory(_vkDevice, &allocInfo, nullptr,
+			&bufferMemory) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate buffer memory!");
+		}
+
+		vkBindBufferMemory(_vkDevice,buffer,bufferMemory,0);
+	}
+
+	BufferHandle createBufferResource(VkDeviceSize size, VkBufferUsageFlags usage,
+		VkMemoryPropertyFlags properties)
+	{
+		BufferResource resource = {};
+		resource.size = size;
+		createBuffer(size, usage, properties, resource.buffer, resource.memory);
+		return _bufferPool.allocate(resource);
+	}
+
+	//ԴԱύ¼Ƶ֡ʹ,һύʱֵɺ
+	uint64_t releaseTimelineValue()
+	{
+		return _frameTimeline.lastSubmittedValue() + 1;
+	}
+
+	void releaseBuffer(BufferHandle handle)
+	{
+		BufferResource resource = _bufferPool.release(handle);
+		VkDevice device = _vkDevice;
+		_destructionQueue.push(releaseTimelineValue(), [device, resource]()
+		{
+			vkDestroyBuffer(device, resource.buffer, nullptr);
+			vkFreeMemory(device, resource.memory, nullptr);
+		});
+	}
+
+	void releaseImage(ImageHandle handle)
+	{
+		ImageResource resource = _imagePool.release(handle);
+		VkDevice device = _vkDevice;
+		_destructionQueue.push(releaseTimelineValue(), [device, resource]()
+		{
+			if (resource.view != VK_NULL_HANDLE)
+				vkDestroyImageView(device, resource.view, nullptr);
+			vkDestroyImage(device, resource.image, nullptr);
+			vkFreeMemory(device, resource.memory, nullptr);
+		});
+	}
+
+	void releasePipeline(PipelineHandle handle)
+	{
+		VkPipeline pipeline = _pipelinePool.release(handle);
+		VkDevice device = _vkDevice;
+		_destructionQueue.push(releaseTimelineValue(), [device, pipeline]()
+		{
+			vkDestroyPipeline(device, pipeline, nullptr);
+		});
+	}
+
+	void releaseDescriptorSet(DescriptorSetHandle handle)
+	{
+		DescriptorSetResource resource = _descriptorSetPool.release(handle);
+		VkDevice device = _vkDevice;
+		_destructionQueue.push(releaseTimelineValue(), [device, resource]()
+		{
+			vkFreeDescriptorSets(device, resource.pool, 1, &resource.set);
+		});
+	}
+
+	void createStagingRing()
+	{
+		TRACE_FUNCTION();
+		_stagingBuffer = createBufferResource(STAGING_RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		//ڱӳ
+		const BufferResource& staging = _bufferPool[_stagingBuffer];
+		void* data;
+		if (vkMapMemory(_vkDevice, staging.memory, 0, STAGING_RING_SIZE, 0, &data) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to map staging ring!");
+		}
+
+		_stagingRing.init(staging.buffer, data, STAGING_RING_SIZE);
+		_transferTimeline.create(_vkDevice);
+	}
+
+	//staging,ռ䲻ʱύ¼Ƶϴȴϴ
+	VkDeviceSize acquireStaging(VkDeviceSize size)
+	{
+		VkDeviceSize offset;
+		while (!_stagingRing.allocate(size, STAGING_ALIGNMENT, offset))
+		{
+			if (_stagingRing.pendingBytes() > 0)
+				flushUploads();
+
+			if (!_stagingRing.hasRetired())
+			{
+				throw std::runtime_error("staging allocation larger than staging ring!");
+			}
+
+			_transferTimeline.wait(_stagingRing.oldestRetiredValue());
+			reclaimUploads();
+		}
+		return offset;
+	}
+
+	VkCommandBuffer uploadCommandBuffer()
+	{
+		if (_uploadCommandBuffer != VK_NULL_HANDLE)
+			return _uploadCommandBuffer;
+
+		//Դ仯,һ֡Ⱦ
+		_damageTracker.invalidate();
+
+		if (!_freeUploadCommandBuffers.empty())
+		{
+			_uploadCommandBuffer = _freeUploadCommandBuffers.back();
+			_freeUploadCommandBuffers.pop_back();
+			vkResetCommandBuffer(_uploadCommandBuffer, 0);
+		}
+		else
+		{
+			VkCommandBufferAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandPool = _commandPool;
+			allocInfo.commandBufferCount = 1;
+
+			if (vkAllocateCommandBuffers(_vkDevice, &allocInfo, &_uploadCommandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to allocate upload command buffer!");
+			}
+		}
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(_uploadCommandBuffer, &beginInfo);
+
+		return _uploadCommandBuffer;
+	}
+
+	//ύ¼Ƶϴ,ʱsignalʱ
+	void flushUploads()
+	{
+		TRACE_FUNCTION();
+		if (_uploadCommandBuffer == VK_NULL_HANDLE)
+			return;
+
+		if (vkEndCommandBuffer(_uploadCommandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to record upload command buffer!");
+		}
+
+		uint64_t signalValue = _transferTimeline.nextValue();
+		VkSemaphore signalSemaphore = _transferTimeline.semaphore();
+
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &_uploadCommandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &signalSemaphore;
+
+		if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit upload command buffer!");
+		}
+
+		_stagingRing.retire(signalValue);
+		_pendingUploadCommandBuffers.push_back({ signalValue, _uploadCommandBuffer });
+		_uploadCommandBuffer = VK_NULL_HANDLE;
+	}
+
+	//ϴռõstagingռָ
+	void reclaimUploads()
+	{
+		uint64_t completedValue = _transferTimeline.completedValue();
+		_stagingRing.reclaim(completedValue);
+
+		while (!_pendingUploadCommandBuffers.empty()
+			&& _pendingUploadCommandBuffers.front().first <= completedValue)
+		{
+			_freeUploadCommandBuffers.push_back(_pendingUploadCommandBuffers.front().second);
+			_pendingUploadCommandBuffers.pop_front();
+		}
+	}
+
+	//һСϴֿ,GPUһʱCPUһ
+	void uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset,
+		const void* data, VkDeviceSize size)
+	{
+		const uint8_t* src = static_cast<const uint8_t*>(data);
+		VkDeviceSize maxChunkSize = _stagingRing.capacity() / 2;
+
+		while (size > 0)
+		{
+			VkDeviceSize chunkSize = std::min(size, maxChunkSize);
+			VkDeviceSize stagingOffset = acquireStaging(chunkSize);
+			memcpy(_stagingRing.data() + stagingOffset, src, static_cast<size_t>(chunkSize));
+
+			VkBufferCopy copyRegion = {};
+			copyRegion.srcOffset = stagingOffset;
+			copyRegion.dstOffset = dstOffset;
+			copyRegion.size = chunkSize;
+			vkCmdCopyBuffer(uploadCommandBuffer(), _stagingRing.buffer(), dstBuffer, 1, &copyRegion);
+
+			src += chunkSize;
+			dstOffset += chunkSize;
+			size -= chunkSize;
+		}
+	}
+
+	void createIndexBuffer()
+	{
+		TRACE_FUNCTION();
+		VkDeviceSize bufferSize = sizeof(uint16_t)*GEOMETRY_INDEX_CAPACITY;
+
+		_indexBuffer = createBufferResource(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		_indexAllocator.init(GEOMETRY_INDEX_CAPACITY);
+	}
+
+	void createMeshes()
+	{
+		TRACE_FUNCTION();
+		_quadMesh = addMesh(quadVertices, quadIndices);
+		_triangleMesh = addMesh(triangleVertices, triangleIndices);
+		_discMesh = loadMesh("meshes/disc.obj");
+	}
+
+	//λ,ڵľֲ
+	//ûṩLODʱΨһһ
+	MeshHandle addMesh(const std::vector<Vertex>& meshVertices,
+		const std::vector<uint16_t>& meshIndices, const std::vector<MeshLod>& lods = {})
+	{
+		Mesh mesh = {};
+		mesh.vertexCount = static_cast<uint32_t>(meshVertices.size());
+		mesh.indexCount = static_cast<uint32_t>(meshIndices.size());
+		if (lods.size() > MAX_MESH_LODS)
+		{
+			throw std::runtime_error("too many mesh LODs!");
+		}
+		if (lods.empty())
+		{
+			mesh.lodCount = 1;
+			mesh.lods[0] = { 0, mesh.indexCount, 0.0f };
+		}
+		else
+		{
+			mesh.lodCount = static_cast<uint32_t>(lods.size());
+			std::copy(lods.begin(), lods.end(), mesh.lods.begin());
+		}
+
+		if (!_vertexAllocator.allocate(mesh.vertexCount, mesh.vertexOffset))
+		{
+			throw std::runtime_error("failed to allocate mesh vertices!");
+		}
+
+		if (!_indexAllocator.allocate(mesh.indexCount, mesh.firstIndex))
+		{
+			_vertexAllocator.free(mesh.vertexOffset, mesh.vertexCount);
+			throw std::runtime_error("failed to allocate mesh indices!");
+		}
+
+		uploadBuffer(_bufferPool[_vertexBuffer].buffer, sizeof(Vertex)*mesh.vertexOffset,
+			meshVertices.data(), sizeof(Vertex)*mesh.vertexCount);
+		uploadBuffer(_bufferPool[_indexBuffer].buffer, sizeof(uint16_t)*mesh.firstIndex,
+			meshIndices.data(), sizeof(uint16_t)*mesh.indexCount);
+
+		return _meshPool.allocate(mesh);
+	}
+
+	//asset_cook決ɵLOD,16λ
+	//ʱǶά,ֻȡλõxy,ɫΪɫ
+	MeshHandle loadMesh(const char* name)
+	{
+		const PackEntry* entry = _assetPack.find(name);
+		if (entry == nullptr || entry->type != ASSET_TYPE_MESH)
+		{
+			throw std::runtime_error(std::string("failed to load mesh ") + name + "!");
+		}
+
+		std::vector<uint8_t> asset(static_cast<size_t>(entry->uncompressedSize));
+		if (!_assetPack.read(*entry, asset.data()))
+		{
+			throw std::runtime_error(std::string("failed to read mesh ") + name + "!");
+		}
+
+		const MeshAssetHeader* header = reinterpret_cast<const MeshAssetHeader*>(asset.data());
+		if (header->vertexStride != sizeof(MeshVertex) || header->indexSize != sizeof(uint32_t)
+			|| header->lodCount == 0 || header->lodCount > MAX_MESH_LODS || header->vertexCount > UINT16_MAX + 1u)
+		{
+			throw std::runtime_error(std::string("unsupported mesh ") + name + "!");
+		}
+
+		const MeshLod* lods = reinterpret_cast<const MeshLod*>(header + 1);
+		const MeshVertex* vertices = reinterpret_cast<const MeshVertex*>(lods + header->lodCount);
+		const uint32_t* indices = reinterpret_cast<const uint32_t*>(vertices + header->vertexCount);
+
+		std::vector<Vertex> meshVertices(header->vertexCount);
+		for (uint32_t i = 0; i < header->vertexCount; ++i)
+		{
+			const MeshVertex& vertex = vertices[i];
+			meshVertices[i] = { {vertex.position[0], vertex.position[1]}, {1.0f, 1.0f, 1.0f},
+				{vertex.texCoord[0], vertex.texCoord[1]} };
+		}
+		std::vector<uint16_t> meshIndices(indices, indices + header->indexCount);
+		return addMesh(meshVertices, meshIndices, std::vector<MeshLod>(lods, lods + header->lodCount));
+	}
+
+	//Աе֡ȡ,ʱɺٹ黹
+	void releaseMesh(MeshHandle handle)
+	{
+		Mesh mesh = _meshPool.release(handle);
+		_destructionQueue.push(releaseTimelineValue(), [this, mesh]()
+		{
+			_vertexAllocator.free(mesh.vertexOffset, mesh.vertexCount);
+			_indexAllocator.free(mesh.firstIndex, mesh.indexCount);
+		});
+	}
+
+	void createDescriptorSetLayout()
+	{
+		TRACE_FUNCTION();
+		//SPIR-Vɫӿ
+		_shaderInterface = reflectShader(readAsset("shaders/vertex.vert"));
+		_shaderInterface.merge(reflectShader(readAsset("shaders/pixel.frag")));
+
+		//ÿݴset 0建ȡ,ɫʹpush constant
+		bool objectBufferFound = false;
+		for (const auto& binding : _shaderInterface.setBindings(0))
+		{
+			if (binding.binding == 1 && binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+				objectBufferFound = true;
+		}
+		if (!objectBufferFound || !_shaderInterface.pushConstantRanges.empty())
+		{
+			throw std::runtime_error("shader object buffer does not match ObjectData!");
+		}
+
+		for (const auto& binding : _shaderInterface.setBindings(1))
+		{
+			if (binding.binding == 0 && binding.descriptorCount != MAX_TEXTURE_PAGES)
+			{
+				throw std::runtime_error("shader texture pages do not match MAX_TEXTURE_PAGES!");
+			}
+		}
+
+		_descriptorSetLayout = _descriptorSetLayoutCache.get(_shaderInterface.setBindings(0));
+		_materialDescriptorSetLayout = _descriptorSetLayoutCache.get(_shaderInterface.setBindings(1));
+	}
+
+	void createUniformBuffers()
+	{
+		TRACE_FUNCTION();
+		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+
+		_uniformBuffers.resize(_swapChainImages.size());
+
+		for (size_t i = 0; i < _swapChainImages.size(); ++i)
+		{
+			_uniformBuffers[i] = createBufferResource(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+				VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+	}
+
+	void createDrawBuffers()
+	{
+		TRACE_FUNCTION();
+		_drawBuffers.resize(_swapChainImages.size());
+		for (auto& buffers : _drawBuffers)
+		{
+			buffers.objectBuffer = createBufferResource(MAX_DRAW_OBJECTS * sizeof(ObjectData),
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			buffers.indirectBuffer = createBufferResource(MAX_DRAW_OBJECTS * sizeof(VkDrawIndexedIndirectCommand),
+				VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			void* objects;
+			void* commands;
+			if (vkMapMemory(_vkDevice, _bufferPool[buffers.objectBuffer].memory, 0, VK_WHOLE_SIZE, 0, &objects) != VK_SUCCESS
+				|| vkMapMemory(_vkDevice, _bufferPool[buffers.indirectBuffer].memory, 0, VK_WHOLE_SIZE, 0, &commands) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to map draw buffers!");
+			}
+			buffers.objects = static_cast<ObjectData*>(objects);
+			buffers.commands = static_cast<VkDrawIndexedIndirectCommand*>(commands);
+		}
+	}
+
+	void createDescriptorPool()
+	{
+		TRACE_FUNCTION();
+		//ÿŽͼƬһ,Сɷbinding
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& binding : _shaderInterface.setBindings(0))
+		{
+			VkDescriptorPoolSize poolSize = {};
+			poolSize.type = binding.descriptorType;
+			poolSize.descriptorCount = binding.descriptorCount*
+				static_cast<uint32_t>(_swapChainImages.size());
+			poolSizes.push_back(poolSize);
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = static_cast<uint32_t>(_swapChainImages.size());
+		//Եͷ
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		
+		if (vkCreateDescriptorPool(_vkDevice, &poolInfo, nullptr,
+			&_descriptorPool)!=VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create descriptor pool!");
+		}
+
+	}
+
+	void createParticleLayouts()
+	{
+		TRACE_FUNCTION();
+		_particleComputeInterface = reflectShader(readAsset("shaders/particle.comp"));
+		if (_particleComputeInterface.pushConstantRanges.empty()
+			|| _particleComputeInterface.pushConstantRanges[0].size > sizeof(ParticleParams))
+		{
+			throw std::runtime_error("particle shader push constants do not match ParticleParams!");
+		}
+
+		_particleDescriptorSetLayout = _descriptorSetLayoutCache.get(_particleComputeInterface.setBindings(0));
+		_particleComputePipelineLayout = _pipelineLayoutCache.get(_descriptorSetLayoutCache,
+			_particleComputeInterface);
+
+		//ӻƺͨʹͬһuniform buffer
+		_particleGraphicsInterface = reflectShader(readAsset("shaders/particle.vert"));
+		_particleGraphicsInterface.merge(reflectShader(readAsset("shaders/particle.frag")));
+		if (_descriptorSetLayoutCache.get(_particleGraphicsInterface.setBindings(0)) != _descriptorSetLayout)
+		{
+			throw std::runtime_error("particle shader descriptors do not match the scene descriptor set!");
+		}
+
+		_particleGraphicsPipelineLayout = _pipelineLayoutCache.get(_descriptorSetLayoutCache,
+			_particleGraphicsInterface);
+	}
+
+	void createParticleComputePipeline()
+	{
+		TRACE_FUNCTION();
+		_particleComputePipeline = _pipelinePool.allocate(
+			createComputePipeline("shaders/particle.comp", _particleComputePipelineLayout));
+	}
+
+	VkPipeline createComputePipeline(const char* shaderPath, VkPipelineLayout layout)
+	{
+		auto compShaderCode = readAsset(shaderPath);
+		VkShaderModule compShaderModule = createShaderModule(compShaderCode);
+
+		VkPipelineShaderStageCreateInfo compShaderStageInfo = {};
+		compShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		compShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		compShaderStageInfo.module = compShaderModule;
+		compShaderStageInfo.pName = "main";
+
+		VkComputePipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = compShaderStageInfo;
+		pipelineInfo.layout = layout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		VkPipeline computePipeline;
+		if (vkCreateComputePipelines(_vkDevice, _pipelineCache, 1, &pipelineInfo,
+			nullptr, &computePipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create compute pipeline!");
+		}
+
+		vkDestroyShaderModule(_vkDevice, compShaderModule, nullptr);
+		return computePipeline;
+	}
+
+	//ɫһֺ͹߲,ÿɫֻԼõİ
+	void createPostLayouts()
+	{
+		TRACE_FUNCTION();
+		for (const char* shader : { "shaders/post_downsample.comp", "shaders/post_exposure.comp",
+			"shaders/post_blur.comp", "shaders/post_tonemap.comp" })
+		{
+			_postInterface.merge(reflectShader(readAsset(shader)));
+		}
+		if (_postInterface.pushConstantRanges.empty()
+			|| _postInterface.pushConstantRanges[0].size > sizeof(PostParams))
+		{
+			throw std::runtime_error("post shader push constants do not match PostParams!");
+		}
+
+		_postDescriptorSetLayout = _descriptorSetLayoutCache.get(_postInterface.setBindings(0));
+		_postPipelineLayout = _pipelineLayoutCache.get(_descriptorSetLayoutCache, _postInterface);
+	}
+
+	void createPostPipelines()
+	{
+		TRACE_FUNCTION();
+		const char* shaders[POST_PIPELINE_COUNT] = { "shaders/post_downsample.comp", "shaders/post_exposure.comp",
+			"shaders/post_blur.comp", "shaders/post_tonemap.comp" };
+		for (uint32_t i = 0; i < POST_PIPELINE_COUNT; ++i)
+		{
+			_postPipelines[i] = _pipelinePool.allocate(createComputePipeline(shaders[i], _postPipelineLayout));
+		}
+
+		_postParams.bloomThreshold = BLOOM_THRESHOLD;
+		_postParams.bloomIntensity = BLOOM_INTENSITY;
+	}
+
+	//ʼعΪ1,ƽΪл
+	void createExposureBuffer()
+	{
+		TRACE_FUNCTION();
+		ExposureState initial = { 1.0f, 0.18f, 1.0f };
+		_exposureBuffer = createBufferResource(sizeof(initial), VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		uploadBuffer(_bufferPool[_exposureBuffer].buffer, 0, &initial, sizeof(initial));
+
+		for (auto& readback : _exposureReadbacks)
+		{
+			readback = createBufferResource(sizeof(ExposureState), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+	}
+
+	//֡λһȾعѾ,عĿʱ֡,澲ֹӦͣ;
+	void checkExposureConverged(size_t frame)
+	{
+		if (!_exposureReadbackPending[frame])
+			return;
+		_exposureReadbackPending[frame] = false;
+
+		ExposureState state;
+		void* data;
+		VkDeviceMemory memory = _bufferPool[_exposureReadbacks[frame]].memory;
+		if (vkMapMemory(_vkDevice, memory, 0, sizeof(state), 0, &data) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to map exposure readback buffer!");
+		}
+		memcpy(&state, data, sizeof(state));
+		vkUnmapMemory(_vkDevice, memory);
+
+		_exposureAdapting = std::abs(state.exposure - state.targetExposure)
+			> EXPOSURE_CONVERGED_RATIO * state.targetExposure;
+	}
+
+	//binding 0ͼƬ,1ͼƬ,2Ȳֺ,3ع,4Ƿ;õͼƬVK_NULL_HANDLE
+	void writePostDescriptorSet(VkDescriptorSet set, VkImageView input, VkImageLayout inputLayout,
+		VkImageView output, VkImageView bloom)
+	{
+		VkDescriptorImageInfo inputInfo = { _textureSampler, input, inputLayout };
+		VkDescriptorImageInfo outputInfo = { VK_NULL_HANDLE, output, VK_IMAGE_LAYOUT_GENERAL };
+		VkDescriptorImageInfo bloomInfo = { _textureSampler, bloom, VK_IMAGE_LAYOUT_GENERAL };
+		VkDescriptorBufferInfo luminanceInfo = { _bufferPool[_luminanceBuffer].buffer, 0, VK_WHOLE_SIZE };
+		VkDescriptorBufferInfo exposureInfo = { _bufferPool[_exposureBuffer].buffer, 0, VK_WHOLE_SIZE };
+
+		std::vector<VkWriteDescriptorSet> writes;
+		auto addWrite = [&](uint32_t binding, VkDescriptorType type,
+			const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+		{
+			VkWriteDescriptorSet write = {};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = binding;
+			write.descriptorCount = 1;
+			write.descriptorType = type;
+			write.pImageInfo = imageInfo;
+			write.pBufferInfo = bufferInfo;
+			writes.push_back(write);
+		};
+
+		if (input != VK_NULL_HANDLE)
+			addWrite(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &inputInfo, nullptr);
+		if (output != VK_NULL_HANDLE)
+			addWrite(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &outputInfo, nullptr);
+		addWrite(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &luminanceInfo);
+		addWrite(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &exposureInfo);
+		if (bloom != VK_NULL_HANDLE)
+			addWrite(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &bloomInfo, nullptr);
+
+		vkUpdateDescriptorSets(_vkDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	}
+
+	//ýߴͼƬ,潻ؽ
+	void createPostDescriptorSets()
+	{
+		TRACE_FUNCTION();
+		uint32_t setCount = POST_SET_COUNT + static_cast<uint32_t>(_swapChainImages.size());
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& binding : _postInterface.setBindings(0))
+		{
+			VkDescriptorPoolSize poolSize = {};
+			poolSize.type = binding.descriptorType;
+			poolSize.descriptorCount = binding.descriptorCount * setCount;
+			poolSizes.push_back(poolSize);
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = setCount;
+		if (vkCreateDescriptorPool(_vkDevice, &poolInfo, nullptr, &_postDescriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create post processing descriptor pool!");
+		}
+
+		std::vector<VkDescriptorSetLayout> layouts(setCount, _postDescriptorSetLayout);
+		std::vector<VkDescriptorSet> sets(setCount);
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = _postDescriptorPool;
+		allocInfo.descriptorSetCount = setCount;
+		allocInfo.pSetLayouts = layouts.data();
+		if (vkAllocateDescriptorSets(_vkDevice, &allocInfo, sets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate post processing descriptor sets!");
+		}
+		std::copy(sets.begin(), sets.begin() + POST_SET_COUNT, _postDescriptorSets.begin());
+		_tonemapDescriptorSets.assign(sets.begin() + POST_SET_COUNT, sets.end());
+
+		writePostDescriptorSet(_postDescriptorSets[POST_SET_DOWNSAMPLE], _hdrImageView,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, _bloomImageViews[0], VK_NULL_HANDLE);
+		writePostDescriptorSet(_postDescriptorSets[POST_SET_EXPOSURE], VK_NULL_HANDLE,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_NULL_HANDLE, VK_NULL_HANDLE);
+		writePostDescriptorSet(_postDescriptorSets[POST_SET_BLUR_HORIZONTAL], _bloomImageViews[0],
+			VK_IMAGE_LAYOUT_GENERAL, _bloomImageViews[1], VK_NULL_HANDLE);
+		writePostDescriptorSet(_postDescriptorSets[POST_SET_BLUR_VERTICAL], _bloomImageViews[1],
+			VK_IMAGE_LAYOUT_GENERAL, _bloomImageViews[0], VK_NULL_HANDLE);
+		for (size_t i = 0; i < _tonemapDescriptorSets.size(); ++i)
+		{
+			VkImageView output = _swapChainStorageSupported ? _swapChainImageViews[i] : _ldrImageView;
+			writePostDescriptorSet(_tonemapDescriptorSets[i], _hdrImageView,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, output, _bloomImageViews[0]);
+		}
+	}
+
+	void createParticleGraphicsPipeline()
+	{
+		TRACE_FUNCTION();
+		auto vertShaderCode = readAsset("shaders/particle.vert");
+		auto fragShaderCode = readAsset("shaders/particle.frag");
+
+		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
+		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+		VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
+		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vertShaderStageInfo.module = vertShaderModule;
+		vertShaderStageInfo.pName = "main";
+		VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
+		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		fragShaderStageInfo.module = fragShaderModule;
+		fragShaderStageInfo.pName = "main";
+		VkPipelineShaderStageCreateInfo shaderStages[] = {
+			vertShaderStageInfo,
+			fragShaderStageInfo
+		};
+
+		//ֱӶȡ״̬
+		auto bindingDescription = Particle::Layout::getBindingDescription();
+		auto attributeDescription = Particle::Layout::getAttributeDescriptions();
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = 1;
+		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescription.size());
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescription.data();
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+		inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		VkPipelineViewportStateCreateInfo viewportState = {};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.pViewports = &_viewport;
+		viewportState.scissorCount = 1;
+		viewportState.pScissors = &_scissor;
+
+		VkPipelineRasterizationStateCreateInfo rasterizationStage = {};
+		rasterizationStage.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizationStage.depthClampEnable = VK_FALSE;
+		rasterizationStage.rasterizerDiscardEnable = VK_FALSE;
+		rasterizationStage.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizationStage.lineWidth = 1.0f;
+		rasterizationStage.cullMode = VK_CULL_MODE_NONE;
+		rasterizationStage.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterizationStage.depthBiasEnable = VK_FALSE;
+
+		VkPipelineMultisampleStateCreateInfo multisampleStage = {};
+		multisampleStage.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampleStage.sampleShadingEnable = VK_FALSE;
+		multisampleStage.rasterizationSamples = _msaaSamples;
+		multisampleStage.minSampleShading = 1.0f;
+
+		//֮䲻,ȵд
+		VkPipelineDepthStencilStateCreateInfo depthStencilStage = {};
+		depthStencilStage.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencilStage.depthTestEnable = VK_TRUE;
+		depthStencilStage.depthWriteEnable = VK_FALSE;
+		depthStencilStage.depthCompareOp = VK_COMPARE_OP_LESS;
+		depthStencilStage.depthBoundsTestEnable = VK_FALSE;
+		depthStencilStage.stencilTestEnable = VK_FALSE;
+
+		//ӷ
+		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+			VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachment.blendEnable = VK_TRUE;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo colorBlendStage = {};
+		colorBlendStage.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlendStage.logicOpEnable = VK_FALSE;
+		colorBlendStage.attachmentCount = 1;
+		colorBlendStage.pAttachments = &colorBlendAttachment;
+
+		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = 2;
+		pipelineInfo.pStages = shaderStages;
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizationStage;
+		pipelineInfo.pMultisampleState = &multisampleStage;
+		pipelineInfo.pDepthStencilState = &depthStencilStage;
+		pipelineInfo.pColorBlendState = &colorBlendStage;
+		pipelineInfo.layout = _particleGraphicsPipelineLayout;
+		pipelineInfo.renderPass = _renderPass;
+		pipelineInfo.subpass = LIGHTING_SUBPASS;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+		VkPipeline particlePipeline;
+		if (vkCreateGraphicsPipelines(_vkDevice, _pipelineCache, 1, &pipelineInfo,
+			nullptr, &particlePipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create particle graphics pipeline!");
+		}
+		_particleGraphicsPipeline = _pipelinePool.allocate(particlePipeline);
+
+		vkDestroyShaderModule(_vkDevice, fragShaderModule, nullptr);
+		vkDestroyShaderModule(_vkDevice, vertShaderModule, nullptr);
+	}
+
+	void createLightingLayouts()
+	{
+		TRACE_FUNCTION();
+		if (!DEFERRED_SHADING)
+			return;
+
+		_lightingInterface = reflectShader(readAsset("shaders/lighting.vert"));
+		_lightingInterface.merge(reflectShader(readAsset("shaders/lighting.frag")));
+		if (_lightingInterface.pushConstantRanges.empty()
+			|| _lightingInterface.pushConstantRanges[0].size > sizeof(LightingParams))
+		{
+			throw std::runtime_error("lighting shader push constants do not match LightingParams!");
+		}
+
+		_lightingDescriptorSetLayout = _descriptorSetLayoutCache.get(_lightingInterface.setBindings(0));
+		_lightingPipelineLayout = _pipelineLayoutCache.get(_descriptorSetLayoutCache, _lightingInterface);
+	}
+
+	//ȫ,ÿضйԴһ
+	void createLightingPipeline()
+	{
+		TRACE_FUNCTION();
+		if (!DEFERRED_SHADING)
+			return;
+
+		auto vertShaderCode = readAsset("shaders/lighting.vert");
+		auto fragShaderCode = readAsset("shaders/lighting.frag");
+
+		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
+		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+		VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
+		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vertShaderStageInfo.module = vertShaderModule;
+		vertShaderStageInfo.pName = "main";
+		VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
+		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		fragShaderStageInfo.module = fragShaderModule;
+		fragShaderStageInfo.pName = "main";
+		VkPipelineShaderStageCreateInfo shaderStages[] = {
+			vertShaderStageInfo,
+			fragShaderStageInfo
+		};
+
+		//gl_VertexIndex
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		VkPipelineViewportStateCreateInfo viewportState = {};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.pViewports = &_viewport;
+		viewportState.scissorCount = 1;
+		viewportState.pScissors = &_scissor;
+
+		VkPipelineRasterizationStateCreateInfo rasterizationStage = {};
+		rasterizationStage.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizationStage.depthClampEnable = VK_FALSE;
+		rasterizationStage.rasterizerDiscardEnable = VK_FALSE;
+		rasterizationStage.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizationStage.lineWidth = 1.0f;
+		rasterizationStage.cullMode = VK_CULL_MODE_NONE;
+		rasterizationStage.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterizationStage.depthBiasEnable = VK_FALSE;
+
+		VkPipelineMultisampleStateCreateInfo multisampleStage = {};
+		multisampleStage.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampleStage.sampleShadingEnable = VK_FALSE;
+		multisampleStage.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisampleStage.minSampleShading = 1.0f;
+
+		//subpassֻ,ɫͨinput attachmentȡ
+		VkPipelineDepthStencilStateCreateInfo depthStencilStage = {};
+		depthStencilStage.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencilStage.depthTestEnable = VK_FALSE;
+		depthStencilStage.depthWriteEnable = VK_FALSE;
+		depthStencilStage.depthBoundsTestEnable = VK_FALSE;
+		depthStencilStage.stencilTestEnable = VK_FALSE;
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+			VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachment.blendEnable = VK_FALSE;
+
+		VkPipelineColorBlendStateCreateInfo colorBlendStage = {};
+		colorBlendStage.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlendStage.logicOpEnable = VK_FALSE;
+		colorBlendStage.attachmentCount = 1;
+		colorBlendStage.pAttachments = &colorBlendAttachment;
+
+		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = 2;
+		pipelineInfo.pStages = shaderStages;
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizationStage;
+		pipelineInfo.pMultisampleState = &multisampleStage;
+		pipelineInfo.pDepthStencilState = &depthStencilStage;
+		pipelineInfo.pColorBlendState = &colorBlendStage;
+		pipelineInfo.layout = _lightingPipelineLayout;
+		pipelineInfo.renderPass = _renderPass;
+		pipelineInfo.subpass = LIGHTING_SUBPASS;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+		VkPipeline lightingPipeline;
+		if (vkCreateGraphicsPipelines(_vkDevice, _pipelineCache, 1, &pipelineInfo,
+			nullptr, &lightingPipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create lighting pipeline!");
+		}
+		_lightingPipeline = _pipelinePool.allocate(lightingPipeline);
+
+		vkDestroyShaderModule(_vkDevice, fragShaderModule, nullptr);
+		vkDestroyShaderModule(_vkDevice, vertShaderModule, nullptr);
+	}
+
+	//ԴΧƳųһȦ,ֻڳʼʱϴһ
+	void createLightBuffer()
+	{
+		TRACE_FUNCTION();
+		if (!DEFERRED_SHADING)
+			return;
+
+		std::vector<PointLight> lights(LIGHT_COUNT);
+		for (uint32_t i = 0; i < LIGHT_COUNT; ++i)
+		{
+			float angle = glm::two_pi<float>() * i / LIGHT_COUNT;
+			float height = 0.2f + 0.6f * (i % 4) / 3.0f;
+			glm::vec3 hue = glm::vec3(std::cos(angle), std::cos(angle - glm::two_pi<float>() / 3.0f),
+				std::cos(angle + glm::two_pi<float>() / 3.0f)) * 0.5f + 0.5f;
+			lights[i].positionRange = glm::vec4(std::cos(angle) * 1.2f, std::sin(angle) * 1.2f, height, 1.0f);
+			lights[i].color = glm::vec4(hue * (4.0f / std::sqrt(float(LIGHT_COUNT))), 1.0f);
+		}
+
+		VkDeviceSize bufferSize = sizeof(PointLight) * lights.size();
+		_lightBuffer = createBufferResource(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		uploadBuffer(_bufferPool[_lightBuffer].buffer, 0, lights.data(), bufferSize);
+
+		_lightingParams.ambient = glm::vec4(0.15f, 0.15f, 0.15f, 0.0f);
+		_lightingParams.lightCount = LIGHT_COUNT;
+	}
+
+	void createLightingDescriptorSet()
+	{
+		TRACE_FUNCTION();
+		if (!DEFERRED_SHADING)
+			return;
+
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& binding : _lightingInterface.setBindings(0))
+		{
+			VkDescriptorPoolSize poolSize = {};
+			poolSize.type = binding.descriptorType;
+			poolSize.descriptorCount = binding.descriptorCount;
+			poolSizes.push_back(poolSize);
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = 1;
+		if (vkCreateDescriptorPool(_vkDevice, &poolInfo, nullptr, &_lightingDescriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create lighting descriptor pool!");
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = _lightingDescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &_lightingDescriptorSetLayout;
+		if (vkAllocateDescriptorSets(_vkDevice, &allocInfo, &_lightingDescriptorSet) != VK_SUCCESS)
 		{
-			vkDestroyImageView(_vkDevice, imageView, nullptr);
+			throw std::runtime_error("failed to allocate lighting descriptor set!");
 		}
 
-		vkDestroySwapchainKHR(_vkDevice, _swapChain, nullptr);
+		//input attachmentҪ,Ⱦsubpass 1һ
+		std::array<VkDescriptorImageInfo, 3> imageInfos = { {
+			{ VK_NULL_HANDLE, _gbufferImageViews[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ VK_NULL_HANDLE, _gbufferImageViews[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ VK_NULL_HANDLE, _depthImageView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL } } };
+		VkDescriptorBufferInfo lightInfo = { _bufferPool[_lightBuffer].buffer, 0, VK_WHOLE_SIZE };
+
+		std::array<VkWriteDescriptorSet, 4> writes = {};
+		for (uint32_t i = 0; i < writes.size(); ++i)
+		{
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = _lightingDescriptorSet;
+			writes[i].dstBinding = i;
+			writes[i].descriptorCount = 1;
+			if (i < imageInfos.size())
+			{
+				writes[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				writes[i].pImageInfo = &imageInfos[i];
+			}
+			else
+			{
+				writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writes[i].pBufferInfo = &lightInfo;
+			}
+		}
+		vkUpdateDescriptorSets(_vkDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 	}
 
-	uint32_t findMemoryType(uint32_t typeFilter,VkMemoryPropertyFlags properties)
+	void createParticleBuffer()
 	{
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(_physicalDevice,&memProperties);
+		TRACE_FUNCTION();
+		//ʼ״̬CPUһ,ֻ֮ɼɫ
+		std::vector<Particle> particles(PARTICLE_COUNT);
+		std::mt19937 generator(1234);
+		std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+		for (auto& particle : particles)
+		{
+			float angle = glm::two_pi<float>() * distribution(generator);
+			float radius = 0.8f + 0.1f * distribution(generator);
+			particle.position = Float4(std::cos(angle) * radius, std::sin(angle) * radius,
+				0.0f, 4.0f * distribution(generator));
+			particle.velocity = Float4(-std::sin(angle) * 0.5f, std::cos(angle) * 0.5f, 0.0f, 0.0f);
+		}
 
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i)
+		VkDeviceSize bufferSize = sizeof(Particle) * particles.size();
+		_particleStateBuffer = createBufferResource(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		for (auto& vertexBuffer : _particleVertexBuffers)
 		{
-			if (typeFilter&(1 << i) && (memProperties
-				.memoryTypes[i].propertyFlags&properties) == properties)
-			{
-				return i;
-			}	
+			vertexBuffer = createBufferResource(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 		}
 
-		throw std::runtime_error("failed to find suitable memory type!");
+		//ϴͼζִ,֮״̬ȨͷŸ
+		VkBuffer stateBuffer = _bufferPool[_particleStateBuffer].buffer;
+		uploadBuffer(stateBuffer, 0, particles.data(), bufferSize);
+		if (_computeQueueFamily != _graphicsQueueFamily)
+		{
+			VkBufferMemoryBarrier release = queueOwnershipBarrier(stateBuffer, _graphicsQueueFamily, _computeQueueFamily);
+			release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(uploadCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &release, 0, nullptr);
+		}
 	}
 
-	void createVertexBuffer()
+	//ÿ֡һ: binding 0ģ״̬,binding 1Ǹ֡Ķ㻺
+	void createParticleDescriptorSets()
 	{
-		VkDeviceSize bufferSize = sizeof(vertices[0])*vertices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
+		TRACE_FUNCTION();
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& binding : _particleComputeInterface.setBindings(0))
+		{
+			VkDescriptorPoolSize poolSize = {};
+			poolSize.type = binding.descriptorType;
+			poolSize.descriptorCount = binding.descriptorCount * MAX_FRAMES_IN_FLIGHT;
+			poolSizes.push_back(poolSize);
+		}
 
-		void* data;
-		vkMapMemory(_vkDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), (size_t)bufferSize);
-		vkUnmapMemory(_vkDevice, stagingBufferMemory);
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT|
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,_vertexBuffer,_vertexBufferMemory);
+		if (vkCreateDescriptorPool(_vkDevice, &poolInfo, nullptr,
+			&_particleDescriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create particle descriptor pool!");
+		}
 
-		copyBuffer(stagingBuffer,_vertexBuffer,bufferSize);
+		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		{
+			VkDescriptorSetAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = _particleDescriptorPool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &_particleDescriptorSetLayout;
+
+			DescriptorSetResource resource = {};
+			resource.pool = _particleDescriptorPool;
+			if (vkAllocateDescriptorSets(_vkDevice, &allocInfo, &resource.set) != VK_SUCCESS)
+			{
+				throw std::runtime_error("failed to allocate particle descriptor set!");
+			}
+			_particleDescriptorSets[i] = _descriptorSetPool.allocate(resource);
+
+			std::array<VkDescriptorBufferInfo, 2> bufferInfos = {};
+			bufferInfos[0].buffer = _bufferPool[_particleStateBuffer].buffer;
+			bufferInfos[0].offset = 0;
+			bufferInfos[0].range = VK_WHOLE_SIZE;
+			bufferInfos[1].buffer = _bufferPool[_particleVertexBuffers[i]].buffer;
+			bufferInfos[1].offset = 0;
+			bufferInfos[1].range = VK_WHOLE_SIZE;
+
+			std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
+			for (uint32_t binding = 0; binding < descriptorWrites.size(); ++binding)
+			{
+				descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				descriptorWrites[binding].dstSet = resource.set;
+				descriptorWrites[binding].dstBinding = binding;
+				descriptorWrites[binding].dstArrayElement = 0;
+				descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				descriptorWrites[binding].descriptorCount = 1;
+				descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+			}
 
-		vkDestroyBuffer(_vkDevice,stagingBuffer,nullptr);
-		vkFreeMemory(_vkDevice,stagingBufferMemory,nullptr);
+			vkUpdateDescriptorSets(_vkDevice, static_cast<uint32_t>(descriptorWrites.size()),
+				descriptorWrites.data(), 0, nullptr);
+		}
 	}
 
-	void createBuffer(VkDeviceSize size,VkBufferUsageFlags usage,
-		VkMemoryPropertyFlags properties,VkBuffer& buffer,VkDeviceMemory& bufferMemory)
+	//ҳͲʱڼ䲻,ֻҪһ
+	//ûõҳλָһҳ,֤еÿЧ
+	void createMaterialDescriptorSet()
 	{
-		VkBufferCreateInfo bufferInfo={};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = size;
-		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		TRACE_FUNCTION();
+		std::vector<VkDescriptorPoolSize> poolSizes;
+		for (const auto& binding : _shaderInterface.setBindings(1))
+		{
+			VkDescriptorPoolSize poolSize = {};
+			poolSize.type = binding.descriptorType;
+			poolSize.descriptorCount = binding.descriptorCount;
+			poolSizes.push_back(poolSize);
+		}
 
-		if (vkCreateBuffer(_vkDevice, &bufferInfo, nullptr, &buffer)
-			!= VK_SUCCESS)
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = 1;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+
+		if (vkCreateDescriptorPool(_vkDevice, &poolInfo, nullptr,
+			&_materialDescriptorPool) != VK_SUCCESS)
 		{
-			throw std::runtime_error("failed to create buffer!");
+			throw std::runtime_error("failed to create material descriptor pool!");
 		}
 
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(_vkDevice, buffer, &memRequirements);
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = _materialDescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &_materialDescriptorSetLayout;
 
-		VkMemoryAllocateInfo allocInfo = {};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = findMemoryType(
-			memRequirements.memoryTypeBits,properties);
+		DescriptorSetResource resource = {};
+		resource.pool = _materialDescriptorPool;
+		if (vkAllocateDescriptorSets(_vkDevice, &allocInfo, &resource.set) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate material descriptor set!");
+		}
+		_materialDescriptorSet = _descriptorSetPool.allocate(resource);
 
-		if (vkAllocateMemory(_vkDevice, &allocInfo, nullptr,
-			&bufferMemory) != VK_SUCCESS)
+		std::array<VkDescriptorImageInfo, MAX_TEXTURE_PAGES> imageInfos = {};
+		for (uint32_t i = 0; i < MAX_TEXTURE_PAGES; ++i)
 		{
-			throw std::runtime_error("failed to allocate buffer memory!");
+			ImageHandle page = _texturePages[i < _texturePages.size() ? i : 0];
+			imageInfos[i].sampler = _textureSampler;
+			imageInfos[i].imageView = _imagePool[page].view;
+			imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		}
 
-		vkBindBufferMemory(_vkDevice,buffer,bufferMemory,0);
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer = _bufferPool[_materialBuffer].buffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = VK_WHOLE_SIZE;
+
+		std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
+		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[0].dstSet = resource.set;
+		descriptorWrites[0].dstBinding = 0;
+		descriptorWrites[0].dstArrayElement = 0;
+		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrites[0].descriptorCount = static_cast<uint32_t>(imageInfos.size());
+		descriptorWrites[0].pImageInfo = imageInfos.data();
+
+		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[1].dstSet = resource.set;
+		descriptorWrites[1].dstBinding = 1;
+		descriptorWrites[1].dstArrayElement = 0;
+		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[1].descriptorCount = 1;
+		descriptorWrites[1].pBufferInfo = &bufferInfo;
+
+		vkUpdateDescriptorSets(_vkDevice, static_cast<uint32_t>(descriptorWrites.size()),
+			descriptorWrites.data(), 0, nullptr);
 	}
 
-	void copyBuffer(VkBuffer srcBuffer,VkBuffer dstBuffer,VkDeviceSize size)
+	void writeTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits stage, uint32_t query)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		if (_timestampQueryPool != VK_NULL_HANDLE)
+		{
+			vkCmdWriteTimestamp(commandBuffer, stage, _timestampQueryPool, query);
+		}
+	}
 
-		VkBufferCopy copyRegion = {};
-		copyRegion.srcOffset = 0;
-		copyRegion.dstOffset = 0;
-		copyRegion.size = size;
-		vkCmdCopyBuffer(commandBuffer,srcBuffer,dstBuffer,1,&copyRegion);
-		
-		endSingleTimeCommands(commandBuffer);
+	static VkImageMemoryBarrier imageBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+		VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+	{
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstAccessMask = dstAccess;
+		return barrier;
 	}
 
-	void createIndexBuffer()
+	//عԺɫӳֻ,ƺͶȡ֮䲻Ҫͬ
+	void recordExposureReadback(VkCommandBuffer commandBuffer)
 	{
-		VkDeviceSize bufferSize = sizeof(indices[0])*indices.size();
-		
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,stagingBuffer,stagingBufferMemory);
+		VkMemoryBarrier computeToTransfer = {};
+		computeToTransfer.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		computeToTransfer.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		computeToTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 1, &computeToTransfer, 0, nullptr, 0, nullptr);
+
+		VkBufferCopy region = { 0, 0, sizeof(ExposureState) };
+		vkCmdCopyBuffer(commandBuffer, _bufferPool[_exposureBuffer].buffer,
+			_bufferPool[_exposureReadbacks[_currentFrame]].buffer, 1, &region);
+
+		VkMemoryBarrier transferToHost = {};
+		transferToHost.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		transferToHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		transferToHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+			0, 1, &transferToHost, 0, nullptr, 0, nullptr);
+	}
 
-		void* data;
-		vkMapMemory(_vkDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, indices.data(), (size_t)bufferSize);
-		vkUnmapMemory(_vkDevice, stagingBufferMemory);
+	//HDR -> ֱͶ -> Զع -> ֱģ -> ɫӳд뽻ͼƬ
+	//ÿ׶֮дʱ,׶εGPUʱֱͳ
+	void recordPostProcessing(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t firstQuery)
+	{
+		VkExtent2D halfExtent = bloomExtent();
+		_postParams.deltaTime = _particleParams.deltaTime;
+		auto bindStage = [&](PostPipeline pipeline, VkDescriptorSet set)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelinePool[_postPipelines[pipeline]]);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _postPipelineLayout,
+				0, 1, &set, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, _postPipelineLayout, _postInterface.pushConstantRanges[0].stageFlags,
+				0, sizeof(PostParams), &_postParams);
+		};
+		auto computeBarrier = [&](const std::vector<VkImageMemoryBarrier>& imageBarriers,
+			VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+		{
+			VkMemoryBarrier memoryBarrier = {};
+			memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = srcAccess;
+			memoryBarrier.dstAccessMask = dstAccess;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0, 1, &memoryBarrier, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+		};
+
+		//һ֡ģܸ֮ǷͼƬ,ع⻺һдԱ֡ɼ
+		computeBarrier({ imageBarrier(_bloomImages[0], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+			0, VK_ACCESS_SHADER_WRITE_BIT) }, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		bindStage(POST_PIPELINE_DOWNSAMPLE, _postDescriptorSets[POST_SET_DOWNSAMPLE]);
+		vkCmdDispatch(commandBuffer, postGroupCount(halfExtent.width), postGroupCount(halfExtent.height), 1);
+
+		computeBarrier({}, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		bindStage(POST_PIPELINE_EXPOSURE, _postDescriptorSets[POST_SET_EXPOSURE]);
+		vkCmdDispatch(commandBuffer, 1, 1, 1);
+		recordExposureReadback(commandBuffer);
+		writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, firstQuery + TIMESTAMP_LUMINANCE_END);
+
+		//ɷ˹ģ,ŰֱͼƬ
+		computeBarrier({ imageBarrier(_bloomImages[1], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+			0, VK_ACCESS_SHADER_WRITE_BIT) }, 0, 0);
+		_postParams.blurDirection[0] = 1;
+		_postParams.blurDirection[1] = 0;
+		bindStage(POST_PIPELINE_BLUR, _postDescriptorSets[POST_SET_BLUR_HORIZONTAL]);
+		vkCmdDispatch(commandBuffer, postGroupCount(halfExtent.width), postGroupCount(halfExtent.height), 1);
+
+		//ͬʱǵһͼƬд
+		computeBarrier({}, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+		_postParams.blurDirection[0] = 0;
+		_postParams.blurDirection[1] = 1;
+		bindStage(POST_PIPELINE_BLUR, _postDescriptorSets[POST_SET_BLUR_VERTICAL]);
+		vkCmdDispatch(commandBuffer, postGroupCount(halfExtent.width), postGroupCount(halfExtent.height), 1);
+		writeTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, firstQuery + TIMESTAMP_BLOOM_END);
+
+		//ͼƬľݲҪ;ȴacquireźŵĽ׶ΰʹ
+		VkImage output = _swapChainStorageSupported ? _swapChainImages[imageIndex] : _ldrImage;
+		computeBarrier({ imageBarrier(output, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+			0, VK_ACCESS_SHADER_WRITE_BIT) }, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		bindStage(POST_PIPELINE_TONEMAP, _tonemapDescriptorSets[imageIndex]);
+		vkCmdDispatch(commandBuffer, postGroupCount(_swapChainExtent.width), postGroupCount(_swapChainExtent.height), 1);
+
+		if (_swapChainStorageSupported)
+		{
+			VkImageMemoryBarrier present = imageBarrier(output, VK_IMAGE_LAYOUT_GENERAL,
+				VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_SHADER_WRITE_BIT, 0);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &present);
+			return;
+		}
+
+		//blit˳RGBAʽת
+		std::array<VkImageMemoryBarrier, 2> copyBarriers = {
+			imageBarrier(_ldrImage, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT),
+			imageBarrier(_swapChainImages[imageIndex], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				0, VK_ACCESS_TRANSFER_WRITE_BIT) };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+			static_cast<uint32_t>(copyBarriers.size()), copyBarriers.data());
+
+		VkImageBlit blit = {};
+		blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blit.srcOffsets[1] = { static_cast<int32_t>(_swapChainExtent.width), static_cast<int32_t>(_swapChainExtent.height), 1 };
+		blit.dstSubresource = blit.srcSubresource;
+		blit.dstOffsets[1] = blit.srcOffsets[1];
+		vkCmdBlitImage(commandBuffer, _ldrImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			_swapChainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_NEAREST);
+
+		VkImageMemoryBarrier present = imageBarrier(_swapChainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &present);
+	}
+
+	//ģⵥύ,ͼζǰһ֡Ⱦصִ
+	//ر֡ͼύҪȴļʱֵ
+	uint64_t submitParticleSimulation()
+	{
+		TRACE_FUNCTION();
+		//÷֡һεͼύѾ,ȴļύҲ
+		VkCommandBuffer commandBuffer = _computeCommandBuffers[_currentFrame];
+		vkResetCommandBuffer(commandBuffer, 0);
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to begin recording compute command buffer!");
+		}
+		bool firstDispatch = !_particleStateAcquired;
+		recordParticleSimulation(commandBuffer);
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to record compute command buffer!");
+		}
 
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-			VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			_indexBuffer, _indexBufferMemory);
+		//ʼ״̬ͼζϴͷ,ֻеһģȴЯĴύ
+		//֮ģͼζ޹صϴȴ
+		VkSemaphore waitSemaphore = _transferTimeline.semaphore();
+		VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		uint64_t waitValue = _transferTimeline.lastSubmittedValue();
+		VkSemaphore signalSemaphore = _computeTimeline.semaphore();
+		uint64_t signalValue = _computeTimeline.nextValue();
+
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.waitSemaphoreValueCount = firstDispatch ? 1 : 0;
+		timelineInfo.pWaitSemaphoreValues = &waitValue;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &signalValue;
 
-		copyBuffer(stagingBuffer, _indexBuffer, bufferSize);
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = firstDispatch ? 1 : 0;
+		submitInfo.pWaitSemaphores = &waitSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStage;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &signalSemaphore;
 
-		vkDestroyBuffer(_vkDevice, stagingBuffer, nullptr);
-		vkFreeMemory(_vkDevice, stagingBufferMemory, nullptr);
+		VkResult submitResult;
+		{
+			TRACE_ZONE("vkQueueSubmit(compute)");
+			submitResult = vkQueueSubmit(_computeQueue, 1, &submitInfo, VK_NULL_HANDLE);
+		}
+		if (submitResult != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit compute command buffer!");
+		}
+		return signalValue;
 	}
 
-	void createDescriptorSetLayout()
+	//srcdst岻ͬʱȨת,ͷŷͻȡ¼ͬ,ֻԼһķ
+	static VkBufferMemoryBarrier queueOwnershipBarrier(VkBuffer buffer, uint32_t srcFamily, uint32_t dstFamily)
+	{
+		VkBufferMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = 0;
+		barrier.srcQueueFamilyIndex = srcFamily;
+		barrier.dstQueueFamilyIndex = dstFamily;
+		barrier.buffer = buffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+		return barrier;
+	}
+
+	//ڼԭƽ״̬,д֡õĶ
+	void recordParticleSimulation(VkCommandBuffer commandBuffer)
 	{
-		VkDescriptorSetLayoutBinding uboLayoutBinding = {};
-		uboLayoutBinding.binding = 0;
-		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uboLayoutBinding.descriptorCount = 1;
-		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-		uboLayoutBinding.pImmutableSamplers = nullptr;
+		VkBuffer stateBuffer = _bufferPool[_particleStateBuffer].buffer;
+		VkBuffer vertexBuffer = _bufferPool[_particleVertexBuffers[_currentFrame]].buffer;
 
-		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
-		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		layoutInfo.bindingCount = 1;
-		layoutInfo.pBindings = &uboLayoutBinding;
+		if (!_particleStateAcquired)
+		{
+			//ȡͼζͷŵĳʼ״̬;ͬһʱɴʱߵĵȴ֤ɼ
+			if (_computeQueueFamily != _graphicsQueueFamily)
+			{
+				VkBufferMemoryBarrier acquire = queueOwnershipBarrier(stateBuffer, _graphicsQueueFamily, _computeQueueFamily);
+				acquire.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+				//Դ׶봫ʱߵĵȴ׶һ
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+					VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &acquire, 0, nullptr);
+			}
+			_particleStateAcquired = true;
+		}
+		else
+		{
+			//һģдԱζȡɼ,ύͬһ
+			VkBufferMemoryBarrier barrier = queueOwnershipBarrier(stateBuffer, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
 
-		if (vkCreateDescriptorSetLayout(_vkDevice, &layoutInfo, nullptr,
-			&_descriptorSetLayout) != VK_SUCCESS)
+		//㻺ľֱӸ,Ҫתƻؼ,ȡͼύCPUѾȴ
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelinePool[_particleComputePipeline]);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _particleComputePipelineLayout,
+			0, 1, &_descriptorSetPool[_particleDescriptorSets[_currentFrame]].set, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, _particleComputePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+			0, sizeof(ParticleParams), &_particleParams);
+		vkCmdDispatch(commandBuffer,
+			(_particleParams.particleCount + PARTICLE_WORKGROUP_SIZE - 1) / PARTICLE_WORKGROUP_SIZE, 1, 1);
+
+		//ͷŸͼζ;ͬһʱɼʱߵĵȴ֤Զɼ
+		if (_computeQueueFamily != _graphicsQueueFamily)
 		{
-			throw std::runtime_error("failed to create descriptor set layout!");
+			VkBufferMemoryBarrier release = queueOwnershipBarrier(vertexBuffer, _computeQueueFamily, _graphicsQueueFamily);
+			release.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &release, 0, nullptr);
 		}
 	}
 
-	void createUniformBuffers()
+	void createDynamicGeometryBuffer()
 	{
-		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+		TRACE_FUNCTION();
+		VkDeviceSize bufferSize = DYNAMIC_GEOMETRY_REGION_SIZE * MAX_FRAMES_IN_FLIGHT;
 
-		_uniformBuffers.resize(_swapChainImages.size());
-		_uniformBuffersMemory.resize(_swapChainImages.size());
+		_dynamicGeometryBuffer = createBufferResource(bufferSize,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
-		for (size_t i = 0; i < _swapChainImages.size(); ++i)
+		const BufferResource& resource = _bufferPool[_dynamicGeometryBuffer];
+		void* data;
+		if (vkMapMemory(_vkDevice, resource.memory, 0, bufferSize, 0, &data) != VK_SUCCESS)
 		{
-			createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-				VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				_uniformBuffers[i], _uniformBuffersMemory[i]);
+			throw std::runtime_error("failed to map dynamic geometry buffer!");
 		}
+
+		_dynamicGeometry.init(_vkDevice, resource.buffer, resource.memory, data,
+			DYNAMIC_GEOMETRY_REGION_SIZE, MAX_FRAMES_IN_FLIGHT, true, 1);
 	}
 
-	void createDescriptorPool()
+	//ÿ֡ɵļ,д뵱ǰ֡λ,Ҳͬ
+	void updateDynamicGeometry(float time)
 	{
-		VkDescriptorPoolSize poolSize = {};
-		poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSize.descriptorCount = static_cast<uint32_t>(_swapChainImages.size());
+		TRACE_FUNCTION();
+		const uint32_t segmentCount = 64;
+
+		_dynamicGeometry.begin(static_cast<uint32_t>(_currentFrame));
+		_dynamicDrawObjects.clear();
+
+		//ֱдӳڴ,һο
+		VkDeviceSize vertexOffset;
+		Vertex* ringVertices = static_cast<Vertex*>(_dynamicGeometry.allocate(
+			sizeof(Vertex) * segmentCount * 2, sizeof(Vertex), vertexOffset));
+		VkDeviceSize indexOffset;
+		uint16_t* ringIndices = static_cast<uint16_t*>(_dynamicGeometry.allocate(
+			sizeof(uint16_t) * segmentCount * 6, sizeof(uint16_t), indexOffset));
+		if (ringVertices == nullptr || ringIndices == nullptr)
+		{
+			return;
+		}
 
-		VkDescriptorPoolCreateInfo poolInfo = {};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.pPoolSizes = &poolSize;
-		poolInfo.maxSets = static_cast<uint32_t>(_swapChainImages.size());
-		poolInfo.flags = 0;
-		
-		if (vkCreateDescriptorPool(_vkDevice, &poolInfo, nullptr,
-			&_descriptorPool)!=VK_SUCCESS)
+		for (uint32_t i = 0; i < segmentCount; ++i)
 		{
-			throw std::runtime_error("failed to create descriptor pool!");
+			float angle = glm::two_pi<float>() * i / segmentCount;
+			float radius = 0.8f + 0.05f * std::sin(angle * 6.0f + time * 4.0f);
+			glm::vec2 direction(std::cos(angle), std::sin(angle));
+			glm::vec3 color(0.5f + 0.5f * std::sin(angle + time), 0.5f, 1.0f);
+
+			ringVertices[i * 2] = { Half2(direction * radius), UNorm8x4(color) };
+			ringVertices[i * 2 + 1] = { Half2(direction * (radius + 0.05f)), UNorm8x4(color) };
+
+			uint16_t current = static_cast<uint16_t>(i * 2);
+			uint16_t next = static_cast<uint16_t>((i + 1) % segmentCount * 2);
+			uint16_t* quad = ringIndices + i * 6;
+			quad[0] = current;
+			quad[1] = next;
+			quad[2] = current + 1;
+			quad[3] = current + 1;
+			quad[4] = next;
+			quad[5] = next + 1;
 		}
 
+		DynamicDrawObject ring = {};
+		ring.mesh.vertexOffset = static_cast<uint32_t>(vertexOffset / sizeof(Vertex));
+		ring.mesh.vertexCount = segmentCount * 2;
+		ring.mesh.firstIndex = static_cast<uint32_t>(indexOffset / sizeof(uint16_t));
+		ring.mesh.indexCount = segmentCount * 6;
+		ring.data.model = glm::mat4(1.0f);
+		_dynamicDrawObjects.push_back(ring);
+
+		_dynamicGeometry.flush();
 	}
 
 	void updateUniformBuffer(uint32_t currentImage)
 	{
-		static auto startTime = std::chrono::high_resolution_clock::now();
+		TRACE_FUNCTION();
+		//pollFrameStateѾȡģ߳·״̬
+		const FrameState& state = _frameStates.readBuffer();
+		float time = state.time;
 
-		auto currentTime = std::chrono::high_resolution_clock::now();
+		updateDynamicGeometry(time);
 
-		float time = std::chrono::duration<float,
-			std::chrono::seconds::period>(currentTime-startTime).count();
+		//Ʋ,϶ȳʱͣٺӲɢ
+		_particleParams.deltaTime = std::min(time - _particleParams.time, 1.0f / 30.0f);
+		_particleParams.time = time;
+		_particleParams.particleCount = PARTICLE_COUNT;
 
 		UniformBufferObject ubo = {};
 
-		ubo.model = glm::rotate(glm::mat4(1.0f),time*glm::radians(90.0f),
-			glm::vec3(0.0f,0.0f,1.0f));
-
-		ubo.view = glm::lookAt(glm::vec3(2.0f,2.0f,2.0f),
-			glm::vec3(0.0f,0.0f,0.0f),glm::vec3(0.0f,0.0f,1.0f));
+		ubo.view = state.view;
 
-		ubo.proj = glm::perspective(glm::radians(45.0f),
+		ubo.proj = glm::perspective(glm::radians(CAMERA_FOV_DEGREES),
 			_swapChainExtent.width / (float)_swapChainExtent.height,
-			0.1f, 10.0f);
+			CAMERA_NEAR, CAMERA_FAR);
 
 		ubo.proj[1][1] *= -1;
 
+		//view-projectionÿֻ֡CPUһ
+		ubo.viewProj = ubo.proj*ubo.view;
+		_lightingParams.invViewProj = glm::inverse(ubo.viewProj);
+
+		VkDeviceMemory uniformBufferMemory = _bufferPool[_uniformBuffers[currentImage]].memory;
+
 		void* data;
-		vkMapMemory(_vkDevice, _uniformBuffersMemory[currentImage], 0,
+		vkMapMemory(_vkDevice, uniformBufferMemory, 0,
 			sizeof(ubo), 0, &data);
 		memcpy(data, &ubo, sizeof(ubo));
-		vkUnmapMemory(_vkDevice, _uniformBuffersMemory[currentImage]);
+		vkUnmapMemory(_vkDevice, uniformBufferMemory);
 	}
 
 	void createDescriptorSets()
 	{
+		TRACE_FUNCTION();
 		std::vector<VkDescriptorSetLayout>
 			layouts(_swapChainImages.size(),_descriptorSetLayout);
 
@@ -1457,107 +4818,245 @@ private:
 		allocInfo.descriptorSetCount = static_cast<uint32_t>(_swapChainImages.size());
 		allocInfo.pSetLayouts = layouts.data();
 
-		_descriptorSets.resize(_swapChainImages.size());
+		std::vector<VkDescriptorSet> descriptorSets(_swapChainImages.size());
 		if (vkAllocateDescriptorSets(_vkDevice, &allocInfo,
-			&_descriptorSets[0]) != VK_SUCCESS)
+			descriptorSets.data()) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to allocate descriptor sets");
 		}
 
+		_descriptorSets.resize(_swapChainImages.size());
 		for (size_t i = 0; i < _swapChainImages.size(); ++i)
 		{
+			DescriptorSetResource resource = {};
+			resource.set = descriptorSets[i];
+			resource.pool = _descriptorPool;
+			_descriptorSets[i] = _descriptorSetPool.allocate(resource);
+
 			VkDescriptorBufferInfo bufferInfo = {};
-			bufferInfo.buffer = _uniformBuffers[i];
+			bufferInfo.buffer = _bufferPool[_uniformBuffers[i]].buffer;
 			bufferInfo.offset = 0;
 			bufferInfo.range = sizeof(UniformBufferObject);
 
-			VkWriteDescriptorSet descriptorWrite = {};
-			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrite.dstSet = _descriptorSets[i];
-			descriptorWrite.dstBinding = 0;
-			descriptorWrite.dstArrayElement = 0;
-			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descriptorWrite.descriptorCount = 1;
-			descriptorWrite.pBufferInfo = &bufferInfo;
-			descriptorWrite.pImageInfo = nullptr;
-			descriptorWrite.pTexelBufferView = nullptr;
-
-			vkUpdateDescriptorSets(_vkDevice,1,&descriptorWrite,0,nullptr);
+			VkDescriptorBufferInfo objectBufferInfo = {};
+			objectBufferInfo.buffer = _bufferPool[_drawBuffers[i].objectBuffer].buffer;
+			objectBufferInfo.offset = 0;
+			objectBufferInfo.range = VK_WHOLE_SIZE;
+
+			std::array<VkWriteDescriptorSet, 2> descriptorWrites = {};
+			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[0].dstSet = descriptorSets[i];
+			descriptorWrites[0].dstBinding = 0;
+			descriptorWrites[0].dstArrayElement = 0;
+			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			descriptorWrites[0].descriptorCount = 1;
+			descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[1].dstSet = descriptorSets[i];
+			descriptorWrites[1].dstBinding = 1;
+			descriptorWrites[1].dstArrayElement = 0;
+			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[1].descriptorCount = 1;
+			descriptorWrites[1].pBufferInfo = &objectBufferInfo;
+
+			vkUpdateDescriptorSets(_vkDevice, static_cast<uint32_t>(descriptorWrites.size()),
+				descriptorWrites.data(), 0, nullptr);
 		}
 	}
-
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+	//Ѿߴҳ,Դӳ䵽ҳеһһӾ
+	void createTexturePages()
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-		VkBufferImageCopy region = {};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
+		TRACE_FUNCTION();
+		const PackEntry* entry = _assetPack.find(TEXTURE_TABLE_NAME);
+		if (entry == nullptr || entry->type != ASSET_TYPE_TEXTURE_TABLE)
+		{
+			throw std::runtime_error("failed to load texture table!");
+		}
 
-		region.imageOffset = {0,0,0};
-		region.imageExtent = {width,height,1};
+		std::vector<uint8_t> table(static_cast<size_t>(entry->uncompressedSize));
+		if (!_assetPack.read(*entry, table.data()))
+		{
+			throw std::runtime_error("failed to read texture table!");
+		}
 
-		vkCmdCopyBufferToImage(commandBuffer, buffer, image,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		const TextureTableHeader* header = reinterpret_cast<const TextureTableHeader*>(table.data());
+		const TextureRegion* regions = reinterpret_cast<const TextureRegion*>(header + 1);
+		if (header->pageCount == 0 || header->pageCount > MAX_TEXTURE_PAGES)
+		{
+			throw std::runtime_error("invalid texture page count!");
+		}
+		if (header->pageCount > 1 && !_texturePageIndexingSupported)
+		{
+			throw std::runtime_error("failed to find support for indexing texture pages!");
+		}
 
-		endSingleTimeCommands(commandBuffer);
+		_textureRegions.assign(regions, regions + header->regionCount);
+		for (uint32_t page = 0; page < header->pageCount; ++page)
+		{
+			_texturePages.push_back(createTexturePage(texturePageName(page).c_str()));
+		}
 	}
 
-	void createTextureImage()
+	static bool isBlockCompressedFormat(VkFormat format)
 	{
-		int texWidth, texHeight, texChannels;
-		stbi_uc* pixels = stbi_load("textures/texture.jpg",
-			&texWidth,&texHeight,&texChannels,STBI_rgb_alpha);
+		return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+	}
 
-		VkDeviceSize imageSize = texWidth * texHeight * 4;
+	//ʱκν,ҳһϴ
+	ImageHandle createTexturePage(const char* name)
+	{
+		const PackEntry* entry = _assetPack.find(name);
+		if (entry == nullptr || entry->type != ASSET_TYPE_TEXTURE)
+		{
+			throw std::runtime_error("failed to load texture page!");
+		}
 
-		if (!pixels)
+		//Դŵýstagingʱ,ӳİֱӸ(ѹ)staging,ÿֻ¼һο
+		//δѹĴӳͼϴ,ѹȽѹڴ
+		std::vector<uint8_t> decompressed;
+		const uint8_t* asset = nullptr;
+		VkDeviceSize stagingOffset = 0;
+		bool staged = entry->uncompressedSize <= _stagingRing.capacity() / 2;
+		bool loaded = true;
+		if (staged)
+		{
+			stagingOffset = acquireStaging(entry->uncompressedSize);
+			asset = _stagingRing.data() + stagingOffset;
+			loaded = _assetPack.read(*entry, _stagingRing.data() + stagingOffset);
+		}
+		else if (entry->compression == ASSET_COMPRESSION_NONE)
 		{
-			throw std::runtime_error("failed to load \
-				texture image!");
+			asset = _assetPack.view(*entry).data();
+		}
+		else
+		{
+			decompressed.resize(static_cast<size_t>(entry->uncompressedSize));
+			asset = decompressed.data();
+			loaded = _assetPack.read(*entry, decompressed.data());
 		}
 
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
+		if (!loaded)
+		{
+			throw std::runtime_error("failed to read texture page!");
+		}
 
-		createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		const TextureAssetHeader* header = reinterpret_cast<const TextureAssetHeader*>(asset);
+		const TextureMipLevel* mips = reinterpret_cast<const TextureMipLevel*>(header + 1);
+		VkFormat format = static_cast<VkFormat>(header->format);
 
-		void* data;
-		vkMapMemory(_vkDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-		memcpy(data, pixels, static_cast<size_t>(imageSize));
-		vkUnmapMemory(_vkDevice, stagingBufferMemory);
+		//BCʽֻtextureCompressionBCʹ,ʱ
+		if (isBlockCompressedFormat(format) && !_textureCompressionBCSupported)
+		{
+			throw std::runtime_error("failed to find support for BC texture compression!");
+		}
 
-		stbi_image_free(pixels);
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(_physicalDevice, format, &formatProperties);
+		if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+		{
+			throw std::runtime_error("failed to find supported texture format!");
+		}
 
-		createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_UNORM,
-			VK_IMAGE_TILING_OPTIMAL,
+		ImageResource texture = {};
+		createImage(header->width, header->height, header->mipCount, header->layerCount,
+			VK_SAMPLE_COUNT_1_BIT, format, VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _textureImage, _textureImageMemory);
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.memory);
+		texture.view = createImageView(texture.image, format, VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_VIEW_TYPE_2D_ARRAY, header->mipCount, header->layerCount);
 
-		transitionImageLayout(_textureImage, VK_FORMAT_R8G8B8A8_UNORM,
+		transitionImageLayout(uploadCommandBuffer(), texture.image,
 			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, header->mipCount, header->layerCount);
+
+		for (uint32_t mip = 0; mip < header->mipCount; ++mip)
+		{
+			if (staged)
+			{
+				copyStagingToImage(texture.image, mip, 0, header->layerCount, 0,
+					mips[mip].width, mips[mip].height, stagingOffset + mips[mip].offset);
+				continue;
+			}
 
-		copyBufferToImage(stagingBuffer, _textureImage,
-			static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+			VkDeviceSize layerSize = mips[mip].size / header->layerCount;
+			for (uint32_t layer = 0; layer < header->layerCount; ++layer)
+			{
+				uploadImageLevel(texture.image, mip, layer, mips[mip].width, mips[mip].height,
+					asset + mips[mip].offset + layerSize * layer,
+					header->blockWidth, header->blockHeight, header->blockBytes);
+			}
+		}
 
-		transitionImageLayout(_textureImage, VK_FORMAT_R8G8B8A8_UNORM,
+		transitionImageLayout(uploadCommandBuffer(), texture.image,
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, header->mipCount, header->layerCount);
+
+		return _imagePool.allocate(texture);
+	}
+
+	//ҳ湲һ,ͼеظѰַɫӾ,ֻȡԵ
+	void createTextureSampler()
+	{
+		TRACE_FUNCTION();
+		VkSamplerCreateInfo samplerInfo = {};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+		if (vkCreateSampler(_vkDevice, &samplerInfo, nullptr, &_textureSampler) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create texture sampler!");
+		}
+	}
+
+	//ÿԴһ,ʱֻͨݴݲ±
+	void createMaterials()
+	{
+		TRACE_FUNCTION();
+		std::vector<MaterialData> materials(1);
+		_materialFlags.assign(1, 0);
+		for (const auto& region : _textureRegions)
+		{
+			MaterialData material = {};
+			material.uvTransform = glm::vec4(region.uvScale[0], region.uvScale[1],
+				region.uvOffset[0], region.uvOffset[1]);
+			material.page = region.page;
+			material.layer = region.layer;
+			material.flags = MATERIAL_TEXTURED;
+			_materialIndices[region.nameHash] = static_cast<uint32_t>(materials.size());
+			materials.push_back(material);
+			_materialFlags.push_back(material.flags);
+		}
+
+		VkDeviceSize bufferSize = sizeof(MaterialData) * materials.size();
+		_materialBuffer = createBufferResource(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		uploadBuffer(_bufferPool[_materialBuffer].buffer, 0, materials.data(), bufferSize);
+
+		_quadMaterial = findMaterial("textures/texture.jpg");
+	}
 
-		vkDestroyBuffer(_vkDevice, stagingBuffer, nullptr);
-		vkFreeMemory(_vkDevice, stagingBufferMemory, nullptr);
+	//ԴҲ,Ҳʱ˻
+	uint32_t findMaterial(const char* textureName) const
+	{
+		auto it = _materialIndices.find(hashAssetName(textureName));
+		return it == _materialIndices.end() ? MATERIAL_UNTEXTURED : it->second;
 	}
 
-	void createImage(uint32_t width, uint32_t height, VkFormat format,
+	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t arrayLayers,
+		VkSampleCountFlagBits numSamples, VkFormat format,
 		VkImageTiling tiling, VkImageUsageFlags usage,
 		VkMemoryPropertyFlags properties, VkImage& image,
 		VkDeviceMemory& imageMemory)
@@ -1568,13 +5067,13 @@ private:
 		imageInfo.extent.width = width;
 		imageInfo.extent.height = height;
 		imageInfo.extent.depth = 1;
-		imageInfo.mipLevels = 1;
-		imageInfo.arrayLayers = 1;
+		imageInfo.mipLevels = mipLevels;
+		imageInfo.arrayLayers = arrayLayers;
 		imageInfo.format = format;
 		imageInfo.tiling = tiling;
 		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		imageInfo.usage = usage;
-		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.samples = numSamples;
 		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
 		if (vkCreateImage(_vkDevice, &imageInfo, nullptr, &image)
@@ -1589,8 +5088,17 @@ private:
 		VkMemoryAllocateInfo allocInfo = {};
 		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 		allocInfo.allocationSize = memRequirements.size;
+
+		//ֶ֧Է豸˻ͨԴ
+		VkMemoryPropertyFlags memoryProperties = properties;
+		if ((memoryProperties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+			&& !hasMemoryType(memRequirements.memoryTypeBits, memoryProperties))
+		{
+			memoryProperties &= ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+		}
+
 		allocInfo.memoryTypeIndex = findMemoryType(
-			memRequirements.memoryTypeBits, properties);
+			memRequirements.memoryTypeBits, memoryProperties);
 		if (vkAllocateMemory(_vkDevice, &allocInfo, nullptr
 			, &imageMemory) != VK_SUCCESS)
 		{
@@ -1599,46 +5107,57 @@ private:
 
 		vkBindImageMemory(_vkDevice, image, imageMemory, 0);
 	}
-
-	VkCommandBuffer beginSingleTimeCommands()
+	//ϴһmip㼶һ,зֿӦstaging,תɵ߸
+	//δѹʽĿ1x1,blockBytesÿֽ
+	void uploadImageLevel(VkImage image, uint32_t mipLevel, uint32_t layer, uint32_t width, uint32_t height,
+		const void* data, uint32_t blockWidth, uint32_t blockHeight, uint32_t blockBytes)
 	{
-		VkCommandBufferAllocateInfo allocInfo = {};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = _commandPool;
-		allocInfo.commandBufferCount = 1;
-
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(_vkDevice, &allocInfo, &commandBuffer);
-
-		VkCommandBufferBeginInfo beginInfo = {};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-		return commandBuffer;
+		const uint8_t* src = static_cast<const uint8_t*>(data);
+		uint32_t blocksWide = (width + blockWidth - 1) / blockWidth;
+		uint32_t blockRows = (height + blockHeight - 1) / blockHeight;
+		VkDeviceSize rowSize = static_cast<VkDeviceSize>(blocksWide) * blockBytes;
+		uint32_t maxRows = static_cast<uint32_t>(std::max<VkDeviceSize>(1,
+			_stagingRing.capacity() / 2 / rowSize));
+
+		for (uint32_t row = 0; row < blockRows;)
+		{
+			uint32_t rowCount = std::min(maxRows, blockRows - row);
+			VkDeviceSize chunkSize = rowSize * rowCount;
+			VkDeviceSize stagingOffset = acquireStaging(chunkSize);
+			memcpy(_stagingRing.data() + stagingOffset, src + rowSize * row,
+				static_cast<size_t>(chunkSize));
+
+			//ѹʽͼԵԲǿС
+			uint32_t y = row * blockHeight;
+			copyStagingToImage(image, mipLevel, layer, 1, y, width, std::min(rowCount * blockHeight, height - y),
+				stagingOffset);
+
+			row += rowCount;
+		}
 	}
 
-	void endSingleTimeCommands(VkCommandBuffer commandBuffer)
+	//stagingͼĳmip㼶дӵyпʼheight,stagingν
+	void copyStagingToImage(VkImage image, uint32_t mipLevel, uint32_t baseLayer, uint32_t layerCount,
+		uint32_t y, uint32_t width, uint32_t height, VkDeviceSize stagingOffset)
 	{
-		vkEndCommandBuffer(commandBuffer);
-		
-		VkSubmitInfo submitInfo = {};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-
-		vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(_graphicsQueue);
+		VkBufferImageCopy region = {};
+		region.bufferOffset = stagingOffset;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = mipLevel;
+		region.imageSubresource.baseArrayLayer = baseLayer;
+		region.imageSubresource.layerCount = layerCount;
+		region.imageOffset = { 0, static_cast<int32_t>(y), 0 };
+		region.imageExtent = { width, height, 1 };
 
-		vkFreeCommandBuffers(_vkDevice, _commandPool, 1, &commandBuffer);
+		vkCmdCopyBufferToImage(uploadCommandBuffer(), _stagingRing.buffer(), image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 	}
 
-	void transitionImageLayout(VkImage image, VkFormat format,
-		VkImageLayout oldLayout, VkImageLayout newLayout)
+	void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image,
+		VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
 		VkImageMemoryBarrier barrier = {};
 		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 		barrier.oldLayout = oldLayout;
@@ -1647,10 +5166,10 @@ private:
 		barrier.dstQueueFamilyIndex= VK_QUEUE_FAMILY_IGNORED;
 		barrier.image = image;
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseMipLevel = 1;
-		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = mipLevels;
 		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
+		barrier.subresourceRange.layerCount = layerCount;
 		barrier.srcAccessMask = 0;
 		barrier.dstAccessMask = 0;
 
@@ -1660,7 +5179,7 @@ private:
 		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
 			newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
 		{
-			barrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+			barrier.srcAccessMask = 0;
 			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
 			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
@@ -1682,8 +5201,6 @@ private:
 
 		vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr,
 			0, nullptr, 1, &barrier);
-
-		endSingleTimeCommands(commandBuffer);
 	}
 };
 
@@ -1,2 +0,0 @@
-..\..\VulkanSDK\1.1.101.0\Bin32\glslangValidator.exe -V vertex.vert
-..\..\VulkanSDK\1.1.101.0\Bin32\glslangValidator.exe -V pixel.frag
\ No newline at end of file
@@ -0,0 +1,67 @@
+#version 450
+#extension GL_ARB_separate_shader_objects:enable
+
+//与main.cpp中的PointLight一致,positionRange.w是光照范围
+struct PointLight
+{
+	vec4 positionRange;
+	vec4 color;
+};
+
+//G-buffer只存在于本次渲染流程的tile内存中,只能读取当前像素
+layout(input_attachment_index=0,set=0,binding=0) uniform subpassInput gbufferAlbedo;
+
+layout(input_attachment_index=1,set=0,binding=1) uniform subpassInput gbufferNormal;
+
+layout(input_attachment_index=2,set=0,binding=2) uniform subpassInput gbufferDepth;
+
+layout(std430,set=0,binding=3) readonly buffer LightBuffer
+{
+	PointLight lights[];
+};
+
+//与main.cpp中的LightingParams一致
+layout(push_constant) uniform LightingParams
+{
+	mat4 invViewProj;
+	vec4 ambient;
+	uint lightCount;
+}params;
+
+layout(location=0) in vec2 fragNdc;
+
+layout(location=0) out vec4 outColor;
+
+void main()
+{
+	vec4 albedo=subpassLoad(gbufferAlbedo);
+	float depth=subpassLoad(gbufferDepth).r;
+
+	//没有几何的像素保留清屏颜色
+	if(depth>=1.0)
+	{
+		outColor=albedo;
+		return;
+	}
+
+	//由深度重建世界坐标,不需要额外的位置附件
+	vec4 world=params.invViewProj*vec4(fragNdc,depth,1.0);
+	vec3 position=world.xyz/world.w;
+	vec3 normal=normalize(subpassLoad(gbufferNormal).xyz*2.0-1.0);
+
+	vec3 lighting=params.ambient.rgb;
+	for(uint i=0u;i<params.lightCount;++i)
+	{
+		vec3 toLight=lights[i].positionRange.xyz-position;
+		float distance=length(toLight);
+		float range=lights[i].positionRange.w;
+		if(distance>=range)
+			continue;
+
+		float attenuation=1.0-distance/range;
+		float diffuse=max(dot(normal,toLight/distance),0.0);
+		lighting+=lights[i].color.rgb*diffuse*attenuation*attenuation;
+	}
+
+	outColor=vec4(albedo.rgb*lighting,albedo.a);
+}
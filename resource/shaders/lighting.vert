@@ -0,0 +1,17 @@
+#version 450
+#extension GL_ARB_separate_shader_objects:enable
+
+//不需要顶点缓冲,三个顶点生成覆盖整个屏幕的三角形
+layout(location=0) out vec2 fragNdc;
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+};
+
+void main()
+{
+	vec2 uv=vec2((gl_VertexIndex<<1)&2,gl_VertexIndex&2);
+	fragNdc=uv*2.0-1.0;
+	gl_Position=vec4(fragNdc,0.0,1.0);
+}
@@ -0,0 +1,44 @@
+#version 450
+#extension GL_ARB_separate_shader_objects:enable
+
+layout(location=0) in vec4 inPosition;
+
+layout(location=1) in vec4 inVelocity;
+
+layout(location=0) out vec4 fragColor;
+
+layout(binding=0) uniform UniformBufferObject
+{
+	mat4 view;
+	mat4 proj;
+	mat4 viewProj;
+}ubo;
+
+//粒子不读取物体数据,声明它只是为了和场景着色器共用set 0的布局
+struct ObjectData
+{
+	mat4 model;
+	vec3 normal;
+	uint materialIndex;
+};
+
+layout(std430,binding=1) readonly buffer ObjectBuffer
+{
+	ObjectData objects[];
+};
+
+out gl_PerVertex
+{
+	vec4 gl_Position;
+	float gl_PointSize;
+};
+
+void main()
+{
+	gl_Position=ubo.viewProj*vec4(inPosition.xyz,1.0);
+	gl_PointSize=1.0;
+
+	float speed=clamp(length(inVelocity.xyz),0.0,1.0);
+	float fade=clamp(inPosition.w,0.0,1.0);
+	fragColor=vec4(mix(vec3(0.2,0.4,1.0),vec3(1.0,0.6,0.2),speed)*fade,1.0);
+}
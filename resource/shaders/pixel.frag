@@ -1,11 +1,76 @@
 #version 450
 #extension GL_ARB_separate_shader_objects:enable
 
+//与main.cpp中的MAX_TEXTURE_PAGES和MATERIAL_TEXTURED一致
+#define MAX_TEXTURE_PAGES 8
+#define MATERIAL_TEXTURED 1u
+#define MATERIAL_SPECIALIZED 0x80000000u
+
+//0是通用变体,从材质表读取标志;带MATERIAL_SPECIALIZED时低位就是材质标志,分支在管线编译时消除
+layout(constant_id=0) const uint MATERIAL_VARIANT=0u;
+
+//延迟着色时才有法线附件,前向渲染的管线不写location 1
+layout(constant_id=1) const bool WRITE_NORMAL=false;
+
 layout(location=0) in vec3 fragColor;
 
+layout(location=1) in vec2 fragTexCoord;
+
+layout(location=2) flat in uint fragMaterialIndex;
+
+layout(location=3) in vec3 fragNormal;
+
+//延迟着色时写入G-buffer的材质颜色和法线,前向渲染时只写颜色
 layout(location=0) out vec4 outColor;
 
+layout(location=1) out vec4 outNormal;
+
+//uvTransform.xy是子矩形大小,zw是偏移,以页面尺寸归一化
+struct Material
+{
+	vec4 uvTransform;
+	uint page;
+	uint layer;
+	uint flags;
+	uint padding;
+};
+
+//所有纹理打包在少数几个纹理数组页面中,整个场景只绑定一次
+layout(set=1,binding=0) uniform sampler2DArray texturePages[MAX_TEXTURE_PAGES];
+
+layout(std430,set=1,binding=1) readonly buffer MaterialTable
+{
+	Material materials[];
+};
+
 void main()
 {
-	outColor=vec4(fragColor,1.0);
-}
\ No newline at end of file
+	Material material=materials[fragMaterialIndex];
+	vec4 color=vec4(fragColor,1.0);
+	uint flags=(MATERIAL_VARIANT&MATERIAL_SPECIALIZED)!=0u?MATERIAL_VARIANT:material.flags;
+
+	if((flags&MATERIAL_TEXTURED)!=0u)
+	{
+		//在子矩形内重复,梯度取重复前的坐标,接缝处不会跳到最小的mip
+		vec2 uv=fract(fragTexCoord)*material.uvTransform.xy+material.uvTransform.zw;
+		vec2 dx=dFdx(fragTexCoord)*material.uvTransform.xy;
+		vec2 dy=dFdy(fragTexCoord)*material.uvTransform.xy;
+
+		//向内收缩实际采样的mip上的半个texel,双线性过滤不会采到图集中相邻的纹理
+		//三线性过滤混合相邻两级,按较粗的一级收缩;子矩形太小时收缩到中心
+		vec2 pageSize=vec2(textureSize(texturePages[material.page],0).xy);
+		float lod=log2(max(max(length(dx*pageSize),length(dy*pageSize)),1e-8));
+		float level=clamp(ceil(lod),0.0,float(textureQueryLevels(texturePages[material.page])-1));
+		vec2 halfTexel=min(0.5*exp2(level)/pageSize,material.uvTransform.xy*0.5);
+		uv=clamp(uv,material.uvTransform.zw+halfTexel,
+			material.uvTransform.zw+material.uvTransform.xy-halfTexel);
+
+		color*=textureGrad(texturePages[material.page],vec3(uv,float(material.layer)),dx,dy);
+	}
+
+	outColor=color;
+	if(WRITE_NORMAL)
+	{
+		outNormal=vec4(normalize(fragNormal)*0.5+0.5,1.0);
+	}
+}
@@ -5,15 +5,37 @@ layout(location=0) in vec2 inPosition;
 
 layout(location=1) in vec3 inColor;
 
+layout(location=2) in vec2 inTexCoord;
+
 layout(location=0) out vec3 fragColor;
 
+layout(location=1) out vec2 fragTexCoord;
+
+layout(location=2) flat out uint fragMaterialIndex;
+
+layout(location=3) out vec3 fragNormal;
+
 layout(binding=0) uniform UniformBufferObject
 {
-	mat4 model;
 	mat4 view;
 	mat4 proj;
+	mat4 viewProj;
 }ubo;
 
+//与main.cpp中的ObjectData一致,normal是CPU上每个物体变换一次的世界空间法线
+struct ObjectData
+{
+	mat4 model;
+	vec3 normal;
+	uint materialIndex;
+};
+
+//按绘制排序后的顺序存放,间接命令的firstInstance指向每条命令的第一个物体
+layout(std430,binding=1) readonly buffer ObjectBuffer
+{
+	ObjectData objects[];
+};
+
 out gl_PerVertex
 {
 	vec4 gl_Position;
@@ -21,8 +43,15 @@ out gl_PerVertex
 
 void main()
 {
-	gl_Position= ubo.proj*ubo.view*ubo.model*
-					vec4(inPosition,0.0,1.0);
+	ObjectData object=objects[gl_InstanceIndex];
+	vec4 worldPosition=object.model*vec4(inPosition,0.0,1.0);
+	gl_Position=ubo.viewProj*worldPosition;
 
 	fragColor=inColor;
+	fragTexCoord=inTexCoord;
+	fragMaterialIndex=object.materialIndex;
+
+	//法线翻转到朝向相机的一面
+	vec3 cameraPosition=-transpose(mat3(ubo.view))*ubo.view[3].xyz;
+	fragNormal=dot(object.normal,cameraPosition-worldPosition.xyz)<0.0?-object.normal:object.normal;
 }
@@ -0,0 +1,1238 @@
+//Դ決
+//resourceĿ¼,ɫmipѹΪBC1ҳ桢Ż,
+//ΪLOD,дһѰַԴ
+//ÿԴݹϣ決,ûб仯ʱֱӸû
+//÷: asset_cook --source <dir> --output <pack> --cache <dir> --glslang <glslangValidator>
+
+#include <vulkan/vulkan.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "../AssetPack.h"
+#include "../TexturePacker.h"
+#include "../MeshSimplifier.h"
+
+#ifdef ASSET_PACK_ZSTD
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+//決㷨ʽ仯ʱ޸,ʹлʧЧ
+#ifdef ASSET_PACK_ZSTD
+const char* const COOKER_VERSION = "asset_cook 7 zstd";
+#else
+const char* const COOKER_VERSION = "asset_cook 7";
+#endif
+const int VERTEX_CACHE_SIZE = 32;
+//ÿLODĿһһ,򻯲һ3/4ʱֹͣ
+//ΧжԽΪλ,ֵLODκξ϶ֵ
+const float MESH_LOD_MAX_ERROR = 0.05f;
+const size_t MESH_LOD_MIN_REDUCTION_PERCENT = 75;
+//СڸôСԴѹ;ѹʹýϸߵļ,ѹٶ뼶޹
+const size_t COMPRESSION_THRESHOLD = 64 * 1024;
+const int COMPRESSION_LEVEL = 19;
+
+struct CookOptions
+{
+	fs::path sourceDir;
+	fs::path outputPath;
+	fs::path cacheDir;
+	std::string glslang;
+	//glslangValidator --version,ɫʧЧ
+	std::string glslangVersion;
+};
+
+//dataдеֽ,ѹʱǷֿѹ
+struct CookedAsset
+{
+	std::string name;
+	AssetType type;
+	AssetCompression compression = ASSET_COMPRESSION_NONE;
+	uint64_t uncompressedSize = 0;
+	uint64_t contentHash = 0;
+	std::vector<uint8_t> data;
+};
+
+//ļ: CachedAssetHeader | data
+struct CachedAssetHeader
+{
+	uint32_t compression;
+	uint32_t reserved;
+	uint64_t uncompressedSize;
+	uint64_t contentHash;
+};
+
+static std::vector<uint8_t> readBinary(const fs::path& path)
+{
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+	{
+		throw std::runtime_error("failed to open " + path.string() + "!");
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	std::vector<uint8_t> buffer(fileSize);
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(buffer.data()), fileSize);
+	return buffer;
+}
+
+//дʱļٸ,;ʧܲ°ļ
+static void writeBinary(const fs::path& path, const std::vector<uint8_t>& data)
+{
+	fs::path temporary = path;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("failed to write " + temporary.string() + "!");
+		}
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+	fs::rename(temporary, path);
+}
+
+static bool readCachedAsset(const fs::path& path, CookedAsset& asset)
+{
+	if (!fs::exists(path))
+		return false;
+
+	std::vector<uint8_t> cached = readBinary(path);
+	if (cached.size() < sizeof(CachedAssetHeader))
+		return false;
+
+	CachedAssetHeader header;
+	memcpy(&header, cached.data(), sizeof(header));
+	asset.compression = static_cast<AssetCompression>(header.compression);
+	asset.uncompressedSize = header.uncompressedSize;
+	asset.contentHash = header.contentHash;
+	asset.data.assign(cached.begin() + sizeof(header), cached.end());
+	return true;
+}
+
+static void writeCachedAsset(const fs::path& path, const CookedAsset& asset)
+{
+	CachedAssetHeader header = {};
+	header.compression = asset.compression;
+	header.uncompressedSize = asset.uncompressedSize;
+	header.contentHash = asset.contentHash;
+
+	std::vector<uint8_t> cached;
+	cached.reserve(sizeof(header) + asset.data.size());
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&header);
+	cached.insert(cached.end(), bytes, bytes + sizeof(header));
+	cached.insert(cached.end(), asset.data.begin(), asset.data.end());
+	writeBinary(path, cached);
+}
+
+template<typename T>
+static void appendPod(std::vector<uint8_t>& out, const T& value)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static void alignTo(std::vector<uint8_t>& out, size_t alignment)
+{
+	out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+}
+
+static std::string toHex(uint64_t value)
+{
+	char text[17];
+	snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+	return text;
+}
+
+static AssetType assetTypeFromExtension(const std::string& extension, bool& known)
+{
+	known = true;
+	if (extension == ".vert" || extension == ".frag" || extension == ".comp")
+		return ASSET_TYPE_SHADER;
+	if (extension == ".jpg" || extension == ".png" || extension == ".tga" || extension == ".bmp")
+		return ASSET_TYPE_TEXTURE;
+	if (extension == ".obj")
+		return ASSET_TYPE_MESH;
+	known = false;
+	return ASSET_TYPE_SHADER;
+}
+
+//ɫ---------------------------------------------------------------------
+
+static std::string quoteCommand(std::string command)
+{
+#ifdef _WIN32
+	//cmd.exeȥһ
+	command = "\"" + command + "\"";
+#endif
+	return command;
+}
+
+static std::string queryGlslangVersion(const CookOptions& options)
+{
+	fs::path output = options.cacheDir / "glslang_version.txt";
+	std::string command = "\"" + options.glslang + "\" --version > \"" + output.string() + "\"";
+	if (std::system(quoteCommand(command).c_str()) != 0)
+	{
+		throw std::runtime_error("failed to query glslang version!");
+	}
+
+	std::vector<uint8_t> version = readBinary(output);
+	fs::remove(output);
+	return std::string(version.begin(), version.end());
+}
+
+//#includeļ(ļĿ¼)ݹؼӽ,ÿļֻһ
+static uint64_t hashShaderIncludes(const fs::path& source, const std::vector<uint8_t>& input,
+	uint64_t key, std::set<fs::path>& visited)
+{
+	std::istringstream stream(std::string(input.begin(), input.end()));
+	std::string line;
+	while (std::getline(stream, line))
+	{
+		std::istringstream tokens(line);
+		std::string directive;
+		tokens >> directive;
+		if (directive != "#include")
+			continue;
+
+		std::string name;
+		tokens >> name;
+		if (name.size() < 2 || (name.front() != '"' && name.front() != '<'))
+		{
+			throw std::runtime_error("invalid #include in " + source.string() + "!");
+		}
+		fs::path include = fs::weakly_canonical(source.parent_path() / name.substr(1, name.size() - 2));
+		if (!visited.insert(include).second)
+			continue;
+
+		std::vector<uint8_t> content = readBinary(include);
+		std::string includeName = include.generic_string();
+		key = hashBytes(includeName.data(), includeName.size(), key);
+		key = hashBytes(content.data(), content.size(), key);
+		key = hashShaderIncludes(include, content, key, visited);
+	}
+	return key;
+}
+
+static std::vector<uint8_t> cookShader(const fs::path& source, const CookOptions& options)
+{
+	fs::path output = options.cacheDir / (toHex(hashAssetName(source.string().c_str())) + ".spv");
+	std::string command = "\"" + options.glslang + "\" -V --target-env vulkan1.1 \"" + source.string() + "\" -o \"" + output.string() + "\"";
+	if (std::system(quoteCommand(command).c_str()) != 0)
+	{
+		throw std::runtime_error("failed to compile shader " + source.string() + "!");
+	}
+
+	std::vector<uint8_t> spirv = readBinary(output);
+	fs::remove(output);
+	return spirv;
+}
+
+//---------------------------------------------------------------------
+
+static float srgbToLinear(uint8_t value)
+{
+	float c = value / 255.0f;
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static uint8_t linearToSrgb(float value)
+{
+	float c = std::clamp(value, 0.0f, 1.0f);
+	c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+	return static_cast<uint8_t>(c * 255.0f + 0.5f);
+}
+
+//2x2ʽ˲,ߴʱԵظ
+//ɫͨsRGB,뵽Կռƽٱ,alphaֱƽ
+static std::vector<uint8_t> downsample(const std::vector<uint8_t>& src, uint32_t width, uint32_t height,
+	uint32_t& outWidth, uint32_t& outHeight)
+{
+	static const std::array<float, 256> toLinear = []
+	{
+		std::array<float, 256> table;
+		for (uint32_t i = 0; i < 256; ++i)
+			table[i] = srgbToLinear(static_cast<uint8_t>(i));
+		return table;
+	}();
+
+	outWidth = std::max(1u, width / 2);
+	outHeight = std::max(1u, height / 2);
+	std::vector<uint8_t> dst(static_cast<size_t>(outWidth) * outHeight * 4);
+
+	for (uint32_t y = 0; y < outHeight; ++y)
+	{
+		uint32_t y0 = std::min(y * 2, height - 1);
+		uint32_t y1 = std::min(y * 2 + 1, height - 1);
+		for (uint32_t x = 0; x < outWidth; ++x)
+		{
+			uint32_t x0 = std::min(x * 2, width - 1);
+			uint32_t x1 = std::min(x * 2 + 1, width - 1);
+			const uint8_t* p00 = &src[(static_cast<size_t>(y0) * width + x0) * 4];
+			const uint8_t* p01 = &src[(static_cast<size_t>(y0) * width + x1) * 4];
+			const uint8_t* p10 = &src[(static_cast<size_t>(y1) * width + x0) * 4];
+			const uint8_t* p11 = &src[(static_cast<size_t>(y1) * width + x1) * 4];
+			uint8_t* out = &dst[(static_cast<size_t>(y) * outWidth + x) * 4];
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				out[c] = linearToSrgb((toLinear[p00[c]] + toLinear[p01[c]] + toLinear[p10[c]] + toLinear[p11[c]]) * 0.25f);
+			}
+			out[3] = static_cast<uint8_t>((p00[3] + p01[3] + p10[3] + p11[3] + 2) / 4);
+		}
+	}
+	return dst;
+}
+
+static uint16_t packRgb565(const int color[3])
+{
+	return static_cast<uint16_t>(((color[0] * 31 + 127) / 255) << 11
+		| ((color[1] * 63 + 127) / 255) << 5
+		| ((color[2] * 31 + 127) / 255));
+}
+
+static void unpackRgb565(uint16_t packed, int color[3])
+{
+	int r = (packed >> 11) & 31;
+	int g = (packed >> 5) & 63;
+	int b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+//Χж˵,ͨɫͨѡԽ,1/16
+static void encodeBc1Block(const uint8_t texels[16][4], uint8_t out[8])
+{
+	int minColor[3] = { 255, 255, 255 };
+	int maxColor[3] = { 0, 0, 0 };
+	int mean[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			minColor[c] = std::min<int>(minColor[c], texels[i][c]);
+			maxColor[c] = std::max<int>(maxColor[c], texels[i][c]);
+			mean[c] += texels[i][c];
+		}
+	}
+
+	int covariance[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; ++i)
+	{
+		int green = texels[i][1] * 16 - mean[1];
+		for (int c = 0; c < 3; ++c)
+		{
+			covariance[c] += (texels[i][c] * 16 - mean[c]) * green;
+		}
+	}
+	for (int c : { 0, 2 })
+	{
+		if (covariance[c] < 0)
+			std::swap(minColor[c], maxColor[c]);
+	}
+
+	for (int c = 0; c < 3; ++c)
+	{
+		int inset = (maxColor[c] - minColor[c]) / 16;
+		maxColor[c] -= inset;
+		minColor[c] += inset;
+	}
+
+	uint16_t color0 = packRgb565(maxColor);
+	uint16_t color1 = packRgb565(minColor);
+	//color0 > color1ʱʹ4ɫģʽ
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		int palette[4][3];
+		unpackRgb565(color0, palette[0]);
+		unpackRgb565(color1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int best = 0;
+			int bestDistance = INT32_MAX;
+			for (int p = 0; p < 4; ++p)
+			{
+				int distance = 0;
+				for (int c = 0; c < 3; ++c)
+				{
+					int d = texels[i][c] - palette[p][c];
+					distance += d * d;
+				}
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = p;
+				}
+			}
+			indices |= static_cast<uint32_t>(best) << (i * 2);
+		}
+	}
+
+	out[0] = static_cast<uint8_t>(color0);
+	out[1] = static_cast<uint8_t>(color0 >> 8);
+	out[2] = static_cast<uint8_t>(color1);
+	out[3] = static_cast<uint8_t>(color1 >> 8);
+	for (int i = 0; i < 4; ++i)
+	{
+		out[4 + i] = static_cast<uint8_t>(indices >> (i * 8));
+	}
+}
+
+static std::vector<uint8_t> encodeBc1(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height)
+{
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+	std::vector<uint8_t> blocks(static_cast<size_t>(blocksWide) * blocksHigh * 8);
+
+	for (uint32_t by = 0; by < blocksHigh; ++by)
+	{
+		for (uint32_t bx = 0; bx < blocksWide; ++bx)
+		{
+			//4x4ıԵظһ/
+			uint8_t texels[16][4];
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				uint32_t x = std::min(bx * 4 + i % 4, width - 1);
+				uint32_t y = std::min(by * 4 + i / 4, height - 1);
+				memcpy(texels[i], &rgba[(static_cast<size_t>(y) * width + x) * 4], 4);
+			}
+			encodeBc1Block(texels, &blocks[(static_cast<size_t>(by) * blocksWide + bx) * 8]);
+		}
+	}
+	return blocks;
+}
+
+//mipsеoffsetpayload,дʱΪԴ
+static std::vector<uint8_t> writeTextureAsset(const TextureAssetHeader& header,
+	std::vector<TextureMipLevel> mips, const std::vector<uint8_t>& payload)
+{
+	std::vector<uint8_t> out;
+	appendPod(out, header);
+	size_t tableOffset = out.size();
+	out.resize(out.size() + sizeof(TextureMipLevel) * mips.size());
+	alignTo(out, 16);
+	uint64_t payloadOffset = out.size();
+	for (auto& mip : mips)
+	{
+		mip.offset += payloadOffset;
+	}
+	memcpy(&out[tableOffset], mips.data(), sizeof(TextureMipLevel) * mips.size());
+	out.insert(out.end(), payload.begin(), payload.end());
+	return out;
+}
+
+//͸ѹΪBC1,͸ͨıRGBA8,layerCountΪ1
+//ԴͼƬsRGBɫ,ʹsRGBʽ,ʱӲ뵽Կռ
+static std::vector<uint8_t> cookTexture(const std::vector<uint8_t>& source, const fs::path& path)
+{
+	int width, height, channels;
+	stbi_uc* pixels = stbi_load_from_memory(source.data(), static_cast<int>(source.size()),
+		&width, &height, &channels, STBI_rgb_alpha);
+	if (!pixels)
+	{
+		throw std::runtime_error("failed to decode texture " + path.string() + "!");
+	}
+
+	std::vector<uint8_t> level(pixels, pixels + static_cast<size_t>(width) * height * 4);
+	stbi_image_free(pixels);
+
+	bool opaque = true;
+	for (size_t i = 3; i < level.size(); i += 4)
+	{
+		if (level[i] != 255)
+		{
+			opaque = false;
+			break;
+		}
+	}
+
+	TextureAssetHeader header = {};
+	header.format = opaque ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_R8G8B8A8_SRGB;
+	header.width = static_cast<uint32_t>(width);
+	header.height = static_cast<uint32_t>(height);
+	header.mipCount = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+	header.blockWidth = opaque ? 4 : 1;
+	header.blockHeight = opaque ? 4 : 1;
+	header.blockBytes = opaque ? 8 : 4;
+	header.layerCount = 1;
+
+	std::vector<TextureMipLevel> mips(header.mipCount);
+	std::vector<uint8_t> payload;
+	uint32_t levelWidth = header.width;
+	uint32_t levelHeight = header.height;
+	for (uint32_t mip = 0; mip < header.mipCount; ++mip)
+	{
+		if (mip > 0)
+		{
+			level = downsample(level, levelWidth, levelHeight, levelWidth, levelHeight);
+		}
+
+		std::vector<uint8_t> encoded = opaque ? encodeBc1(level, levelWidth, levelHeight) : level;
+		alignTo(payload, 16);
+		mips[mip].offset = payload.size();
+		mips[mip].size = encoded.size();
+		mips[mip].width = levelWidth;
+		mips[mip].height = levelHeight;
+		payload.insert(payload.end(), encoded.begin(), encoded.end());
+	}
+
+	return writeTextureAsset(header, mips, payload);
+}
+
+//---------------------------------------------------------------------
+
+//ForsythĶ㻺
+static float vertexCacheScore(int cachePosition, uint32_t remainingTriangles)
+{
+	if (remainingTriangles == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		//ùε̶,ƫճֵ
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.0f - (cachePosition - 3) / float(VERTEX_CACHE_SIZE - 3), 1.5f);
+	}
+
+	//ʣԽٵĶԽ,
+	score += 2.0f * std::pow(float(remainingTriangles), -0.5f);
+	return score;
+}
+
+static std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t index : indices)
+	{
+		++remaining[index];
+	}
+
+	//ÿõб,ǰremainingδ
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+	}
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		vertexScore[v] = vertexCacheScore(-1, remaining[v]);
+	}
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	int best = -1;
+	float bestScore = -1.0f;
+	for (size_t t = 0; t < triangleCount; ++t)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (triangleScore[t] > bestScore)
+		{
+			bestScore = triangleScore[t];
+			best = static_cast<int>(t);
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	size_t scanCursor = 0;
+
+	while (result.size() < indices.size())
+	{
+		//еĶûʣʱ,ȡһδ
+		if (best < 0)
+		{
+			while (emitted[scanCursor])
+				++scanCursor;
+			best = static_cast<int>(scanCursor);
+		}
+
+		const uint32_t* triangle = &indices[best * 3];
+		emitted[best] = true;
+		newCache.assign(triangle, triangle + 3);
+
+		for (int k = 0; k < 3; ++k)
+		{
+			uint32_t v = triangle[k];
+			result.push_back(v);
+
+			uint32_t* begin = &adjacency[adjacencyOffset[v]];
+			uint32_t* end = begin + remaining[v];
+			std::iter_swap(std::find(begin, end, static_cast<uint32_t>(best)), end - 1);
+			--remaining[v];
+		}
+
+		for (uint32_t v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				newCache.push_back(v);
+		}
+
+		//ĶλΪ-1,ఴλ
+		for (size_t i = 0; i < newCache.size(); ++i)
+		{
+			uint32_t v = newCache[i];
+			int position = i < VERTEX_CACHE_SIZE ? static_cast<int>(i) : -1;
+			cachePosition[v] = position;
+
+			float score = vertexCacheScore(position, remaining[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			for (uint32_t a = 0; a < remaining[v]; ++a)
+			{
+				triangleScore[adjacency[adjacencyOffset[v] + a]] += delta;
+			}
+		}
+		if (newCache.size() > VERTEX_CACHE_SIZE)
+			newCache.resize(VERTEX_CACHE_SIZE);
+		cache.swap(newCache);
+
+		best = -1;
+		bestScore = -1.0f;
+		for (uint32_t v : cache)
+		{
+			for (uint32_t a = 0; a < remaining[v]; ++a)
+			{
+				uint32_t t = adjacency[adjacencyOffset[v] + a];
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					best = static_cast<int>(t);
+				}
+			}
+		}
+	}
+	return result;
+}
+
+static int resolveObjIndex(int index, size_t count)
+{
+	//OBJ1ʼ,ʾĩβ
+	return index > 0 ? index - 1 : static_cast<int>(count) + index;
+}
+
+//ϸһʼ𼶼,ÿһĽϼ۵
+static std::vector<MeshLod> buildMeshLods(const std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices)
+{
+	float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (const MeshVertex& vertex : vertices)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			boundsMin[k] = std::min(boundsMin[k], vertex.position[k]);
+			boundsMax[k] = std::max(boundsMax[k], vertex.position[k]);
+		}
+	}
+	float extent = std::sqrt((boundsMax[0] - boundsMin[0]) * (boundsMax[0] - boundsMin[0])
+		+ (boundsMax[1] - boundsMin[1]) * (boundsMax[1] - boundsMin[1])
+		+ (boundsMax[2] - boundsMin[2]) * (boundsMax[2] - boundsMin[2]));
+
+	MeshSimplifier simplifier(vertices[0].position, sizeof(MeshVertex) / sizeof(float),
+		static_cast<uint32_t>(vertices.size()), indices);
+
+	std::vector<MeshLod> lods = { { 0, static_cast<uint32_t>(indices.size()), 0.0f } };
+	std::vector<uint32_t> lodIndices(indices);
+	while (lods.size() < MAX_MESH_LODS)
+	{
+		size_t previousCount = lodIndices.size();
+		float error = simplifier.simplify(lodIndices, previousCount / 6 * 3, MESH_LOD_MAX_ERROR * extent);
+		if (lodIndices.empty() || lodIndices.size() * 100 > previousCount * MESH_LOD_MIN_REDUCTION_PERCENT)
+			break;
+
+		lods.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices.size()), error });
+		indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+	}
+	return lods;
+}
+
+//ȡOBJv/vt/vn/f,ΰǻ,ȥغLODŻ
+static std::vector<uint8_t> cookMesh(const std::vector<uint8_t>& source, const fs::path& path)
+{
+	std::vector<std::array<float, 3>> positions;
+	std::vector<std::array<float, 3>> normals;
+	std::vector<std::array<float, 2>> texCoords;
+	std::vector<MeshVertex> vertices;
+	std::vector<uint32_t> indices;
+	std::map<std::array<int, 3>, uint32_t> vertexMap;
+
+	std::istringstream stream(std::string(source.begin(), source.end()));
+	std::string line;
+	while (std::getline(stream, line))
+	{
+		std::istringstream tokens(line);
+		std::string keyword;
+		tokens >> keyword;
+
+		if (keyword == "v")
+		{
+			std::array<float, 3> p = {};
+			tokens >> p[0] >> p[1] >> p[2];
+			positions.push_back(p);
+		}
+		else if (keyword == "vn")
+		{
+			std::array<float, 3> n = {};
+			tokens >> n[0] >> n[1] >> n[2];
+			normals.push_back(n);
+		}
+		else if (keyword == "vt")
+		{
+			std::array<float, 2> uv = {};
+			tokens >> uv[0] >> uv[1];
+			//OBJv,Vulkan
+			uv[1] = 1.0f - uv[1];
+			texCoords.push_back(uv);
+		}
+		else if (keyword == "f")
+		{
+			std::vector<uint32_t> face;
+			std::string corner;
+			while (tokens >> corner)
+			{
+				std::array<int, 3> key = { -1, -1, -1 };
+				std::istringstream parts(corner);
+				std::string part;
+				for (int i = 0; i < 3 && std::getline(parts, part, '/'); ++i)
+				{
+					if (part.empty())
+						continue;
+					size_t count = i == 0 ? positions.size() : i == 1 ? texCoords.size() : normals.size();
+					key[i] = resolveObjIndex(std::stoi(part), count);
+					if (key[i] < 0 || key[i] >= static_cast<int>(count))
+					{
+						throw std::runtime_error("invalid face index in " + path.string() + "!");
+					}
+				}
+
+				auto found = vertexMap.find(key);
+				if (found == vertexMap.end())
+				{
+					MeshVertex vertex = {};
+					memcpy(vertex.position, positions[key[0]].data(), sizeof(vertex.position));
+					if (key[1] >= 0)
+						memcpy(vertex.texCoord, texCoords[key[1]].data(), sizeof(vertex.texCoord));
+					if (key[2] >= 0)
+						memcpy(vertex.normal, normals[key[2]].data(), sizeof(vertex.normal));
+
+					found = vertexMap.emplace(key, static_cast<uint32_t>(vertices.size())).first;
+					vertices.push_back(vertex);
+				}
+				face.push_back(found->second);
+			}
+
+			for (size_t i = 2; i < face.size(); ++i)
+			{
+				indices.push_back(face[0]);
+				indices.push_back(face[i - 1]);
+				indices.push_back(face[i]);
+			}
+		}
+	}
+
+	if (indices.empty())
+	{
+		throw std::runtime_error("mesh " + path.string() + " has no faces!");
+	}
+
+	std::vector<MeshLod> lods = buildMeshLods(vertices, indices);
+	for (const MeshLod& lod : lods)
+	{
+		std::vector<uint32_t> lodIndices(indices.begin() + lod.firstIndex, indices.begin() + lod.firstIndex + lod.indexCount);
+		lodIndices = optimizeVertexCache(lodIndices, static_cast<uint32_t>(vertices.size()));
+		std::copy(lodIndices.begin(), lodIndices.end(), indices.begin() + lod.firstIndex);
+	}
+
+	//״ʹõ˳Ŷ,߶ȡľֲ
+	//ֵLODʼ,Զֻȡ㻺忪ͷһС
+	std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+	std::vector<MeshVertex> ordered;
+	ordered.reserve(vertices.size());
+	for (auto lod = lods.rbegin(); lod != lods.rend(); ++lod)
+	{
+		for (uint32_t i = lod->firstIndex; i < lod->firstIndex + lod->indexCount; ++i)
+		{
+			uint32_t index = indices[i];
+			if (remap[index] == UINT32_MAX)
+			{
+				remap[index] = static_cast<uint32_t>(ordered.size());
+				ordered.push_back(vertices[index]);
+			}
+		}
+	}
+	for (uint32_t& index : indices)
+	{
+		index = remap[index];
+	}
+
+	MeshAssetHeader header = {};
+	header.vertexCount = static_cast<uint32_t>(ordered.size());
+	header.indexCount = static_cast<uint32_t>(indices.size());
+	header.vertexStride = sizeof(MeshVertex);
+	header.indexSize = sizeof(uint32_t);
+	header.lodCount = static_cast<uint32_t>(lods.size());
+
+	std::vector<uint8_t> out;
+	appendPod(out, header);
+	for (const MeshLod& lod : lods)
+	{
+		appendPod(out, lod);
+	}
+	const uint8_t* vertexBytes = reinterpret_cast<const uint8_t*>(ordered.data());
+	out.insert(out.end(), vertexBytes, vertexBytes + sizeof(MeshVertex) * ordered.size());
+	const uint8_t* indexBytes = reinterpret_cast<const uint8_t*>(indices.data());
+	out.insert(out.end(), indexBytes, indexBytes + sizeof(uint32_t) * indices.size());
+	return out;
+}
+
+//ѹ---------------------------------------------------------------------
+
+//ɫֱӳvkCreateShaderModule,ѹ;ѹʡ10%Ҳԭ
+static void compressAsset(CookedAsset& asset)
+{
+#ifdef ASSET_PACK_ZSTD
+	if (asset.type == ASSET_TYPE_SHADER || asset.data.size() < COMPRESSION_THRESHOLD)
+		return;
+
+	CompressedChunkTable table = {};
+	table.chunkCount = static_cast<uint32_t>((asset.data.size() + ASSET_CHUNK_SIZE - 1) / ASSET_CHUNK_SIZE);
+	table.chunkSize = ASSET_CHUNK_SIZE;
+
+	std::vector<uint8_t> out;
+	appendPod(out, table);
+	size_t offsetsPosition = out.size();
+	out.resize(out.size() + sizeof(uint64_t) * (table.chunkCount + 1));
+
+	std::vector<uint64_t> offsets;
+	std::vector<uint8_t> chunk(ZSTD_compressBound(ASSET_CHUNK_SIZE));
+	for (uint32_t i = 0; i < table.chunkCount; ++i)
+	{
+		size_t begin = static_cast<size_t>(i) * ASSET_CHUNK_SIZE;
+		size_t size = std::min<size_t>(ASSET_CHUNK_SIZE, asset.data.size() - begin);
+		size_t compressed = ZSTD_compress(chunk.data(), chunk.size(), &asset.data[begin], size, COMPRESSION_LEVEL);
+		if (ZSTD_isError(compressed))
+		{
+			throw std::runtime_error("failed to compress " + asset.name + "!");
+		}
+
+		offsets.push_back(out.size());
+		out.insert(out.end(), chunk.begin(), chunk.begin() + compressed);
+	}
+	offsets.push_back(out.size());
+	memcpy(&out[offsetsPosition], offsets.data(), sizeof(uint64_t) * offsets.size());
+
+	if (out.size() * 10 > asset.data.size() * 9)
+		return;
+
+	asset.compression = ASSET_COMPRESSION_ZSTD;
+	asset.data.swap(out);
+#else
+	(void)asset;
+#endif
+}
+
+//---------------------------------------------------------------------
+
+static const TextureAssetHeader* textureHeader(const CookedAsset& texture)
+{
+	return reinterpret_cast<const TextureAssetHeader*>(texture.data.data());
+}
+
+static const TextureMipLevel* textureMips(const CookedAsset& texture)
+{
+	return reinterpret_cast<const TextureMipLevel*>(textureHeader(texture) + 1);
+}
+
+//һǰmipCount㰴иƵҳе(x,y),ҳĸÿmip
+static void blitTexture(const CookedAsset& texture, const TexturePlacement& placement,
+	const std::vector<TextureMipLevel>& pageMips, uint32_t mipCount, std::vector<uint8_t>& payload)
+{
+	const TextureAssetHeader* header = textureHeader(texture);
+	const TextureMipLevel* mips = textureMips(texture);
+	for (uint32_t mip = 0; mip < mipCount; ++mip)
+	{
+		const TextureMipLevel& src = mips[mip];
+		const TextureMipLevel& dst = pageMips[mip];
+		size_t srcRowBytes = static_cast<size_t>((src.width + header->blockWidth - 1) / header->blockWidth)
+			* header->blockBytes;
+		size_t dstRowBytes = static_cast<size_t>((dst.width + header->blockWidth - 1) / header->blockWidth)
+			* header->blockBytes;
+		uint32_t srcRows = (src.height + header->blockHeight - 1) / header->blockHeight;
+		uint32_t dstRows = (dst.height + header->blockHeight - 1) / header->blockHeight;
+
+		//ͼеλðߴ,СȻڿ߽
+		uint32_t blockX = (placement.x >> mip) / header->blockWidth;
+		uint32_t blockY = (placement.y >> mip) / header->blockHeight;
+		uint8_t* layer = &payload[dst.offset + dstRowBytes * dstRows * placement.layer];
+		for (uint32_t row = 0; row < srcRows; ++row)
+		{
+			memcpy(layer + dstRowBytes * (blockY + row) + blockX * header->blockBytes,
+				texture.data.data() + src.offset + srcRowBytes * row, srcRowBytes);
+		}
+	}
+}
+
+//ѵ決ϲҳ,ҳ
+//ҳݲʱֱӸûеѹ
+static std::vector<CookedAsset> packTextures(const std::vector<CookedAsset>& textures,
+	const CookOptions& options, uint32_t& cookedCount)
+{
+	TexturePacker packer;
+	for (const auto& texture : textures)
+	{
+		const TextureAssetHeader* header = textureHeader(texture);
+		packer.add({ header->format, header->width, header->height, header->mipCount,
+			header->blockWidth, header->blockHeight });
+	}
+	packer.pack();
+
+	const std::vector<TexturePackPage>& pages = packer.pages();
+	std::vector<CookedAsset> out;
+	for (uint32_t pageIndex = 0; pageIndex < pages.size(); ++pageIndex)
+	{
+		const TexturePackPage& page = pages[pageIndex];
+		std::vector<uint32_t> members;
+		for (uint32_t i = 0; i < textures.size(); ++i)
+		{
+			if (packer.placement(i).page == pageIndex)
+				members.push_back(i);
+		}
+
+		//ͬһҳĸʽͬ,ҳĸԱߴmipҲͬ
+		const TextureAssetHeader* first = textureHeader(textures[members[0]]);
+		const TextureMipLevel* firstMips = textureMips(textures[members[0]]);
+		TextureAssetHeader header = *first;
+		header.width = page.width;
+		header.height = page.height;
+		header.mipCount = page.mipCount;
+		header.layerCount = page.layerCount;
+
+		std::vector<TextureMipLevel> mips(page.mipCount);
+		std::vector<uint8_t> payload;
+		for (uint32_t mip = 0; mip < page.mipCount; ++mip)
+		{
+			uint32_t width = page.atlas ? std::max(1u, page.width >> mip) : firstMips[mip].width;
+			uint32_t height = page.atlas ? std::max(1u, page.height >> mip) : firstMips[mip].height;
+			uint64_t layerSize = static_cast<uint64_t>((width + header.blockWidth - 1) / header.blockWidth)
+				* ((height + header.blockHeight - 1) / header.blockHeight) * header.blockBytes;
+
+			alignTo(payload, 16);
+			mips[mip].offset = payload.size();
+			mips[mip].size = layerSize * page.layerCount;
+			mips[mip].width = width;
+			mips[mip].height = height;
+			//ͼûõ򱣳Ϊ0
+			payload.resize(static_cast<size_t>(payload.size() + mips[mip].size), 0);
+		}
+
+		for (uint32_t member : members)
+		{
+			blitTexture(textures[member], packer.placement(member), mips, page.mipCount, payload);
+		}
+
+		CookedAsset asset;
+		asset.name = texturePageName(pageIndex);
+		asset.type = ASSET_TYPE_TEXTURE;
+		asset.data = writeTextureAsset(header, mips, payload);
+		asset.uncompressedSize = asset.data.size();
+		asset.contentHash = hashBytes(asset.data.data(), asset.data.size());
+
+		uint64_t key = hashBytes(COOKER_VERSION, strlen(COOKER_VERSION));
+		key = hashBytes(&asset.contentHash, sizeof(asset.contentHash), key);
+		fs::path cachePath = options.cacheDir / (toHex(key) + ".page");
+		CookedAsset cached;
+		if (readCachedAsset(cachePath, cached) && cached.contentHash == asset.contentHash)
+		{
+			asset.compression = cached.compression;
+			asset.data.swap(cached.data);
+		}
+		else
+		{
+			compressAsset(asset);
+			writeCachedAsset(cachePath, asset);
+			++cookedCount;
+		}
+		out.push_back(std::move(asset));
+	}
+
+	//ֹϣ,ʱֲ
+	std::vector<TextureRegion> regions;
+	for (uint32_t i = 0; i < textures.size(); ++i)
+	{
+		const TextureAssetHeader* header = textureHeader(textures[i]);
+		const TexturePlacement& placement = packer.placement(i);
+		const TexturePackPage& page = pages[placement.page];
+
+		TextureRegion region = {};
+		region.nameHash = hashAssetName(textures[i].name.c_str());
+		region.page = placement.page;
+		region.layer = placement.layer;
+		region.uvScale[0] = static_cast<float>(header->width) / page.width;
+		region.uvScale[1] = static_cast<float>(header->height) / page.height;
+		region.uvOffset[0] = static_cast<float>(placement.x) / page.width;
+		region.uvOffset[1] = static_cast<float>(placement.y) / page.height;
+		regions.push_back(region);
+	}
+	std::sort(regions.begin(), regions.end(),
+		[](const TextureRegion& a, const TextureRegion& b) { return a.nameHash < b.nameHash; });
+
+	TextureTableHeader tableHeader = {};
+	tableHeader.pageCount = static_cast<uint32_t>(pages.size());
+	tableHeader.regionCount = static_cast<uint32_t>(regions.size());
+
+	CookedAsset table;
+	table.name = TEXTURE_TABLE_NAME;
+	table.type = ASSET_TYPE_TEXTURE_TABLE;
+	appendPod(table.data, tableHeader);
+	for (const auto& region : regions)
+	{
+		appendPod(table.data, region);
+	}
+	table.uncompressedSize = table.data.size();
+	table.contentHash = hashBytes(table.data.data(), table.data.size());
+	compressAsset(table);
+	out.push_back(std::move(table));
+
+	std::cout << "packed " << textures.size() << " textures into " << pages.size() << " texture pages" << std::endl;
+	return out;
+}
+
+//Դ---------------------------------------------------------------------
+
+static void writePack(const fs::path& path, std::vector<CookedAsset>& assets)
+{
+	std::vector<PackEntry> entries;
+	std::vector<uint8_t> data;
+	std::unordered_map<uint64_t, size_t> contentOffsets;
+
+	//Ŀ¼ݶ64ֽڱ߽翪ʼ,ӳֱӰṹ
+	uint64_t tocOffset = ASSET_PACK_ALIGNMENT;
+	uint64_t tocSize = sizeof(PackEntry) * assets.size();
+	uint64_t dataOffset = (tocOffset + tocSize + ASSET_PACK_ALIGNMENT - 1)
+		/ ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+
+	for (const auto& asset : assets)
+	{
+		PackEntry entry = {};
+		entry.nameHash = hashAssetName(asset.name.c_str());
+		entry.contentHash = asset.contentHash;
+		entry.size = asset.data.size();
+		entry.uncompressedSize = asset.uncompressedSize;
+		entry.type = asset.type;
+		entry.compression = asset.compression;
+
+		//ͬԴֻһ,ѹȷԵ,洢ֽҲͬ
+		auto found = contentOffsets.find(entry.contentHash);
+		if (found != contentOffsets.end() && found->second + asset.data.size() <= data.size()
+			&& memcmp(&data[found->second], asset.data.data(), asset.data.size()) == 0)
+		{
+			entry.offset = dataOffset + found->second;
+		}
+		else
+		{
+			alignTo(data, ASSET_PACK_ALIGNMENT);
+			contentOffsets[entry.contentHash] = data.size();
+			entry.offset = dataOffset + data.size();
+			data.insert(data.end(), asset.data.begin(), asset.data.end());
+		}
+		entries.push_back(entry);
+	}
+
+	std::sort(entries.begin(), entries.end(),
+		[](const PackEntry& a, const PackEntry& b) { return a.nameHash < b.nameHash; });
+	for (size_t i = 1; i < entries.size(); ++i)
+	{
+		if (entries[i].nameHash == entries[i - 1].nameHash)
+		{
+			throw std::runtime_error("asset name hash collision!");
+		}
+	}
+
+	PackHeader header = {};
+	header.magic = ASSET_PACK_MAGIC;
+	header.version = ASSET_PACK_VERSION;
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.tocOffset = tocOffset;
+	header.dataOffset = dataOffset;
+
+	std::vector<uint8_t> pack;
+	appendPod(pack, header);
+	pack.resize(tocOffset, 0);
+	for (const auto& entry : entries)
+	{
+		appendPod(pack, entry);
+	}
+	pack.resize(dataOffset, 0);
+	pack.insert(pack.end(), data.begin(), data.end());
+
+	writeBinary(path, pack);
+}
+
+static bool parseOptions(int argc, char** argv, CookOptions& options)
+{
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string flag = argv[i];
+		if (flag == "--source")
+			options.sourceDir = argv[i + 1];
+		else if (flag == "--output")
+			options.outputPath = argv[i + 1];
+		else if (flag == "--cache")
+			options.cacheDir = argv[i + 1];
+		else if (flag == "--glslang")
+			options.glslang = argv[i + 1];
+		else
+			return false;
+	}
+	return !options.sourceDir.empty() && !options.outputPath.empty()
+		&& !options.cacheDir.empty() && !options.glslang.empty();
+}
+
+int main(int argc, char** argv)
+{
+	CookOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::cerr << "usage: asset_cook --source <dir> --output <pack> --cache <dir> --glslang <glslangValidator>" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		fs::create_directories(options.cacheDir);
+		options.glslangVersion = queryGlslangVersion(options);
+
+		//˳ļϵͳ˳޹,ͬõͬİ
+		std::vector<fs::path> sources;
+		for (const auto& item : fs::recursive_directory_iterator(options.sourceDir))
+		{
+			if (item.is_regular_file())
+				sources.push_back(item.path());
+		}
+		std::sort(sources.begin(), sources.end());
+
+		std::vector<CookedAsset> assets;
+		std::vector<CookedAsset> textures;
+		uint32_t cookedCount = 0;
+		for (const auto& source : sources)
+		{
+			bool known;
+			AssetType type = assetTypeFromExtension(source.extension().string(), known);
+			if (!known)
+				continue;
+
+			CookedAsset asset;
+			asset.name = fs::relative(source, options.sourceDir).generic_string();
+			asset.type = type;
+
+			//߰汾չ(ɫ׶)
+			//ɫglslang汾#includeļ
+			std::vector<uint8_t> input = readBinary(source);
+			std::string extension = source.extension().string();
+			uint64_t key = hashBytes(COOKER_VERSION, strlen(COOKER_VERSION));
+			key = hashBytes(extension.data(), extension.size(), key);
+			key = hashBytes(input.data(), input.size(), key);
+			if (type == ASSET_TYPE_SHADER)
+			{
+				std::set<fs::path> visited;
+				key = hashBytes(options.glslangVersion.data(), options.glslangVersion.size(), key);
+				key = hashShaderIncludes(source, input, key, visited);
+			}
+			fs::path cachePath = options.cacheDir / (toHex(key) + ".bin");
+
+			if (!readCachedAsset(cachePath, asset))
+			{
+				std::cout << "cooking " << asset.name << std::endl;
+				switch (type)
+				{
+				case ASSET_TYPE_SHADER: asset.data = cookShader(source, options); break;
+				case ASSET_TYPE_TEXTURE: asset.data = cookTexture(input, source); break;
+				case ASSET_TYPE_MESH: asset.data = cookMesh(input, source); break;
+				//ɴ,Դļ
+				case ASSET_TYPE_TEXTURE_TABLE:
+					throw std::runtime_error("unexpected source asset type for " + source.string() + "!");
+				}
+				asset.uncompressedSize = asset.data.size();
+				asset.contentHash = hashBytes(asset.data.data(), asset.data.size());
+				//Ҫҳ,ѹҳ
+				if (type != ASSET_TYPE_TEXTURE)
+				{
+					compressAsset(asset);
+				}
+				writeCachedAsset(cachePath, asset);
+				++cookedCount;
+			}
+
+			if (type == ASSET_TYPE_TEXTURE)
+				textures.push_back(std::move(asset));
+			else
+				assets.push_back(std::move(asset));
+		}
+
+		//Դд
+		std::vector<CookedAsset> pages = packTextures(textures, options, cookedCount);
+		for (auto& page : pages)
+		{
+			assets.push_back(std::move(page));
+		}
+
+		writePack(options.outputPath, assets);
+		std::cout << "asset pack " << options.outputPath.string() << ": " << assets.size()
+			<< " assets, " << cookedCount << " cooked" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return 0;
+}